@@ -0,0 +1,62 @@
+# Benchmark: per-frame cost of each accept_waveform sample format
+#
+# Feeds the same audio as 20 ms frames three ways and reports the mean time per
+# frame:
+#
+#   - s16le: 16-bit integers, the default path
+#   - f32le: normalized floats handed straight to the NIF (format: :f32le)
+#   - f32 -> s16 in Elixir: the old approach for float pipelines, converting
+#     every frame to 16-bit integers before calling accept_waveform
+#
+# Each pass uses a fresh recognizer so decoder state does not carry over.
+#
+# Usage:
+#   mix run bench/accept_waveform_formats.exs [model_path] [audio_path]
+
+defmodule Bench.AcceptWaveformFormats do
+  @default_model "models/vosk-model-small-en-us-0.15"
+  @default_audio "test/test_audio.raw"
+  @frame_samples 320
+
+  def run(args) do
+    model_path = Enum.at(args, 0, @default_model)
+    audio_path = Enum.at(args, 1, @default_audio)
+
+    {:ok, model} = VoskEx.Model.load(model_path)
+    s16 = File.read!(audio_path)
+
+    s16_frames = for <<frame::binary-size(@frame_samples * 2) <- s16>>, do: frame
+    f32_frames = Enum.map(s16_frames, &to_f32/1)
+
+    IO.puts("frames: #{length(s16_frames)} x #{@frame_samples} samples")
+
+    report("s16le", model, s16_frames, &VoskEx.Recognizer.accept_waveform(&1, &2))
+
+    report("f32le", model, f32_frames, fn rec, frame ->
+      VoskEx.Recognizer.accept_waveform(rec, frame, format: :f32le)
+    end)
+
+    report("f32 -> s16 in Elixir", model, f32_frames, fn rec, frame ->
+      VoskEx.Recognizer.accept_waveform(rec, to_s16(frame))
+    end)
+  end
+
+  defp report(label, model, frames, fun) do
+    {:ok, rec} = VoskEx.Recognizer.new(model, 16000.0)
+    {us, _} = :timer.tc(fn -> Enum.each(frames, &fun.(rec, &1)) end)
+    per_frame = us / length(frames)
+    IO.puts(String.pad_trailing("#{label}:", 24) <> "#{Float.round(per_frame, 1)} us/frame")
+  end
+
+  defp to_f32(frame) do
+    for <<sample::signed-little-16 <- frame>>, into: <<>>, do: <<sample / 32768::float-little-32>>
+  end
+
+  defp to_s16(frame) do
+    for <<sample::float-little-32 <- frame>>, into: <<>> do
+      <<max(min(round(sample * 32768), 32767), -32768)::signed-little-16>>
+    end
+  end
+end
+
+Bench.AcceptWaveformFormats.run(System.argv())
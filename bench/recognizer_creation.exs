@@ -0,0 +1,96 @@
+# Benchmark: scheduler impact of creating many recognizers at once
+#
+# Creates N recognizers concurrently (default 500) and reports normal and
+# dirty CPU scheduler utilization during the burst, plus the worst delay seen
+# by a heartbeat process running on the normal schedulers. With recognizer
+# creation on dirty CPU schedulers the heartbeat delay should stay near 1 ms.
+#
+# Usage:
+#   mix run bench/recognizer_creation.exs [model_path] [count]
+
+defmodule Bench.RecognizerCreation do
+  @default_model "models/vosk-model-small-en-us-0.15"
+
+  def run(args) do
+    model_path = Enum.at(args, 0, @default_model)
+    count = args |> Enum.at(1, "500") |> String.to_integer()
+
+    {:ok, model} = VoskEx.Model.load(model_path)
+    :erlang.system_flag(:scheduler_wall_time, true)
+
+    heartbeat = start_heartbeat()
+    before = :erlang.statistics(:scheduler_wall_time)
+    started = System.monotonic_time(:microsecond)
+
+    1..count
+    |> Task.async_stream(fn _ -> VoskEx.Recognizer.new!(model, 16000.0) end,
+      max_concurrency: count,
+      timeout: :infinity
+    )
+    |> Stream.run()
+
+    elapsed_us = System.monotonic_time(:microsecond) - started
+    after_sample = :erlang.statistics(:scheduler_wall_time)
+    max_delay_us = stop_heartbeat(heartbeat)
+
+    {normal, dirty} = utilization(before, after_sample)
+
+    IO.puts("recognizers created:      #{count}")
+    IO.puts("total time:               #{Float.round(elapsed_us / 1000, 1)} ms")
+    IO.puts("per recognizer:           #{Float.round(elapsed_us / count, 1)} us")
+    IO.puts("normal scheduler util:    #{Float.round(normal * 100, 1)} %")
+    IO.puts("dirty CPU scheduler util: #{Float.round(dirty * 100, 1)} %")
+    IO.puts("max heartbeat delay:      #{Float.round(max_delay_us / 1000, 2)} ms")
+  end
+
+  # Returns average utilization of normal and dirty CPU schedulers between samples
+  defp utilization(before, after_sample) do
+    normal_count = :erlang.system_info(:schedulers)
+
+    deltas =
+      for {id, active1, total1} <- Enum.sort(after_sample),
+          {^id, active0, total0} <- before do
+        {id, active1 - active0, total1 - total0}
+      end
+
+    {normal, dirty} = Enum.split_with(deltas, fn {id, _, _} -> id <= normal_count end)
+    {ratio(normal), ratio(dirty)}
+  end
+
+  defp ratio([]), do: 0.0
+
+  defp ratio(deltas) do
+    {active, total} =
+      Enum.reduce(deltas, {0, 0}, fn {_, a, t}, {acc_a, acc_t} -> {acc_a + a, acc_t + t} end)
+
+    if total == 0, do: 0.0, else: active / total
+  end
+
+  # Heartbeat process: sleeps 1 ms at a time and records the worst overshoot
+  defp start_heartbeat do
+    parent = self()
+    spawn_link(fn -> heartbeat_loop(parent, 0) end)
+  end
+
+  defp heartbeat_loop(parent, max_delay) do
+    t0 = System.monotonic_time(:microsecond)
+
+    receive do
+      :stop -> send(parent, {:heartbeat, max_delay})
+    after
+      1 ->
+        delay = System.monotonic_time(:microsecond) - t0 - 1000
+        heartbeat_loop(parent, max(max_delay, delay))
+    end
+  end
+
+  defp stop_heartbeat(pid) do
+    send(pid, :stop)
+
+    receive do
+      {:heartbeat, max_delay} -> max_delay
+    end
+  end
+end
+
+Bench.RecognizerCreation.run(System.argv())
@@ -0,0 +1,54 @@
+# Benchmark: cost of the per-recognizer lock on the uncontended path
+#
+# Every recognizer NIF try-locks the recognizer before calling libvosk. This
+# compares a trivial recognizer NIF (set_words: resource lookup + try-lock +
+# flag store) against a NIF with no resource and no lock (set_log_level), so
+# the difference is the overhead added per call. A contended call is also
+# shown, which must return {:error, :busy} instead of blocking.
+#
+# Usage:
+#   mix run bench/recognizer_lock.exs [model_path] [iterations]
+
+defmodule Bench.RecognizerLock do
+  @default_model "models/vosk-model-small-en-us-0.15"
+
+  def run(args) do
+    model_path = Enum.at(args, 0, @default_model)
+    iterations = args |> Enum.at(1, "1000000") |> String.to_integer()
+
+    {:ok, model} = VoskEx.Model.load(model_path)
+    {:ok, %VoskEx.Recognizer{ref: ref} = rec} = VoskEx.Recognizer.new(model, 16000.0)
+
+    baseline = per_call_ns(iterations, fn -> VoskEx.set_log_level(-1) end)
+    locked = per_call_ns(iterations, fn -> VoskEx.set_words(ref, 0) end)
+
+    IO.puts("iterations:                 #{iterations}")
+    IO.puts("NIF call, no lock:          #{Float.round(baseline, 1)} ns")
+    IO.puts("recognizer NIF with lock:   #{Float.round(locked, 1)} ns")
+    IO.puts("lock + lookup overhead:     #{Float.round(locked - baseline, 1)} ns")
+
+    # Hold the recognizer in a long dirty call and probe it from here
+    audio = :binary.copy(<<0::16>>, 16000 * 30)
+    task = Task.async(fn -> VoskEx.Recognizer.accept_waveform(rec, audio) end)
+    Process.sleep(5)
+    IO.puts("contended call returns:     #{inspect(VoskEx.Recognizer.set_words(rec, true))}")
+    Task.await(task, :infinity)
+  end
+
+  defp per_call_ns(iterations, fun) do
+    # Warm up before timing
+    Enum.each(1..1000, fn _ -> fun.() end)
+
+    {us, _} = :timer.tc(fn -> loop(iterations, fun) end)
+    us * 1000 / iterations
+  end
+
+  defp loop(0, _fun), do: :ok
+
+  defp loop(n, fun) do
+    fun.()
+    loop(n - 1, fun)
+  end
+end
+
+Bench.RecognizerLock.run(System.argv())
@@ -0,0 +1,313 @@
+# Benchmark suite: throughput, latency and real-time factor
+#
+# Runs every scenario below against one model and audio file, prints a table
+# per scenario and optionally writes all figures as JSON, so runs before and
+# after a NIF change can be compared:
+#
+#   - model_load: cold load time (each load runs in a fresh process, so the
+#     previous handle is collected and the model registry does not share it)
+#   - chunk_rtf: one stream fed in chunks of several sizes; wall-clock and
+#     native (NIF-measured) real-time factor, mean and p99 latency per call
+#   - concurrency: N streams sharing one model, doubling N up to twice the
+#     dirty CPU scheduler count; aggregate audio seconds decoded per second
+#     and dirty scheduler utilization show where the schedulers saturate
+#   - result_fetch: cost of final_result with word timings and alternatives
+#     on versus off, for both JSON decoders
+#   - result_terms: reductions and heap words per result for the JSON as a
+#     charlist (how the NIF returned it before it switched to binaries) and
+#     as a binary. The charlist is rebuilt from the binary with
+#     :binary.bin_to_list/1, the same one cons cell per byte that
+#     enif_make_string built; building it is not counted, as reductions
+#     spent inside the NIF were not either
+#
+# RTF is processing time divided by audio duration, so lower is better.
+#
+# Usage:
+#   mix run bench/suite.exs [--model PATH] [--audio PATH] [--only a,b]
+#                           [--json OUT.json] [--compare BASELINE.json]
+#
+# --compare prints the relative change of every metric against a previous
+# --json output; positive numbers mean the metric grew.
+
+defmodule Bench.Suite do
+  @default_model "models/vosk-model-small-en-us-0.15"
+  @default_audio "test/test_audio.raw"
+  @sample_rate 16000
+  @scenarios ~w(model_load chunk_rtf concurrency result_fetch result_terms)
+  @chunk_ms [20, 100, 500, 2000]
+  @load_runs 3
+  @fetch_runs 5
+  @term_runs 1000
+
+  def run(args) do
+    {opts, _, _} =
+      OptionParser.parse(args,
+        strict: [model: :string, audio: :string, only: :string, json: :string, compare: :string]
+      )
+
+    model_path = Keyword.get(opts, :model, @default_model)
+    audio = File.read!(Keyword.get(opts, :audio, @default_audio))
+    only = if opts[:only], do: String.split(opts[:only], ","), else: @scenarios
+
+    IO.puts("audio: #{Float.round(audio_seconds(audio), 2)} s, model: #{model_path}")
+
+    # Model load has to run before anything else holds the model
+    results =
+      Enum.flat_map(@scenarios, fn scenario ->
+        if scenario in only, do: scenario(scenario, model_path, audio), else: []
+      end)
+
+    if opts[:json], do: write_json(opts[:json], model_path, results)
+    if opts[:compare], do: compare(opts[:compare], results)
+  end
+
+  defp scenario("model_load", model_path, _audio) do
+    header("model_load")
+
+    for run <- 1..@load_runs do
+      # The handle never leaves the task, so it is collected when the task
+      # exits and the next load is cold in libvosk
+      task =
+        Task.async(fn ->
+          {us, {:ok, _model}} = :timer.tc(fn -> VoskEx.Model.load(model_path) end)
+          us
+        end)
+
+      us = Task.await(task, :infinity)
+      Process.sleep(100)
+      row("run #{run}", %{load_ms: us / 1000})
+      result("model_load", %{run: run}, %{load_ms: us / 1000})
+    end
+  end
+
+  defp scenario("chunk_rtf", model_path, audio) do
+    header("chunk_rtf")
+    {:ok, model} = VoskEx.Model.load(model_path)
+
+    for chunk_ms <- @chunk_ms do
+      {:ok, rec} = VoskEx.Recognizer.new(model, @sample_rate / 1)
+      chunks = chunks(audio, chunk_ms)
+
+      latencies =
+        Enum.map(chunks, fn chunk ->
+          {us, _} = :timer.tc(fn -> VoskEx.Recognizer.accept_waveform(rec, chunk) end)
+          us
+        end)
+
+      {final_us, _} = :timer.tc(fn -> VoskEx.Recognizer.final_result(rec) end)
+      stats = VoskEx.Recognizer.stats(rec)
+      wall_s = (Enum.sum(latencies) + final_us) / 1_000_000
+
+      metrics = %{
+        rtf: wall_s / stats.audio_seconds,
+        native_rtf: stats.decode_ns / 1.0e9 / stats.audio_seconds,
+        mean_call_us: Enum.sum(latencies) / length(latencies),
+        p99_call_us: percentile(latencies, 0.99),
+        final_result_us: final_us
+      }
+
+      row("#{chunk_ms} ms", metrics)
+      result("chunk_rtf", %{chunk_ms: chunk_ms}, metrics)
+    end
+  end
+
+  defp scenario("concurrency", model_path, audio) do
+    header("concurrency")
+    {:ok, model} = VoskEx.Model.load(model_path)
+    :erlang.system_flag(:scheduler_wall_time, true)
+    max_streams = 2 * :erlang.system_info(:dirty_cpu_schedulers)
+    chunks = chunks(audio, 100)
+
+    for streams <- Stream.iterate(1, &(&1 * 2)) |> Enum.take_while(&(&1 <= max_streams)) do
+      recognizers = for _ <- 1..streams, do: VoskEx.Recognizer.new!(model, @sample_rate / 1)
+      before = :erlang.statistics(:scheduler_wall_time)
+
+      {us, _} =
+        :timer.tc(fn ->
+          recognizers
+          |> Task.async_stream(
+            fn rec ->
+              Enum.each(chunks, &VoskEx.Recognizer.accept_waveform(rec, &1))
+              VoskEx.Recognizer.final_result(rec)
+            end,
+            max_concurrency: streams,
+            timeout: :infinity
+          )
+          |> Stream.run()
+        end)
+
+      dirty = dirty_utilization(before, :erlang.statistics(:scheduler_wall_time))
+      wall_s = us / 1_000_000
+
+      metrics = %{
+        audio_s_per_s: streams * audio_seconds(audio) / wall_s,
+        stream_rtf: wall_s / audio_seconds(audio),
+        dirty_cpu_util: dirty
+      }
+
+      row("#{streams} streams", metrics)
+      result("concurrency", %{streams: streams}, metrics)
+    end
+  end
+
+  defp scenario("result_fetch", model_path, audio) do
+    header("result_fetch")
+    {:ok, model} = VoskEx.Model.load(model_path)
+    chunks = chunks(audio, 100)
+
+    configs = [
+      {"plain", []},
+      {"words", words: true},
+      {"words + 5 alternatives", words: true, max_alternatives: 5}
+    ]
+
+    for {label, settings} <- configs, decode <- [:jason, :native] do
+      {:ok, rec} = VoskEx.Recognizer.new(model, @sample_rate / 1)
+      VoskEx.Recognizer.set_words(rec, Keyword.get(settings, :words, false))
+      VoskEx.Recognizer.set_max_alternatives(rec, Keyword.get(settings, :max_alternatives, 0))
+
+      times =
+        for _ <- 1..@fetch_runs do
+          Enum.each(chunks, &VoskEx.Recognizer.accept_waveform(rec, &1))
+          fetch = fn -> VoskEx.Recognizer.final_result(rec, decode: decode) end
+          {us, {:ok, _}} = :timer.tc(fetch)
+          us
+        end
+
+      metrics = %{mean_us: Enum.sum(times) / length(times), min_us: Enum.min(times)}
+      row("#{label} (#{decode})", metrics)
+      result("result_fetch", %{config: label, decode: decode}, metrics)
+    end
+  end
+
+  defp scenario("result_terms", model_path, audio) do
+    header("result_terms")
+    {:ok, model} = VoskEx.Model.load(model_path)
+
+    for {label, settings} <- [{"plain", []}, {"words", words: true}] do
+      {:ok, rec} = VoskEx.Recognizer.new(model, @sample_rate / 1)
+      VoskEx.Recognizer.set_words(rec, Keyword.get(settings, :words, false))
+      VoskEx.Recognizer.accept_waveform(rec, audio)
+      json = VoskEx.get_final_result(rec.ref)
+
+      for {representation, term} <- [charlist: :binary.bin_to_list(json), binary: json] do
+        metrics = Map.put(term_cost(term), :json_bytes, byte_size(json))
+        row("#{label} (#{representation})", metrics)
+        result("result_terms", %{config: label, representation: representation}, metrics)
+      end
+    end
+  end
+
+  defp chunks(audio, chunk_ms) do
+    size = div(@sample_rate * chunk_ms, 1000) * 2
+    for <<chunk::binary-size(size) <- audio>>, do: chunk
+  end
+
+  defp audio_seconds(audio), do: byte_size(audio) / 2 / @sample_rate
+
+  # Decode `term` as the result functions do, in a fresh process so the
+  # reductions and memory are this work alone. Memory is the process growth
+  # per decode with every decoded result kept alive, so the two
+  # representations differ by the garbage their conversion leaves.
+  defp term_cost(term) do
+    task =
+      Task.async(fn ->
+        :erlang.garbage_collect()
+        [reductions: r0, memory: m0] = :erlang.process_info(self(), [:reductions, :memory])
+        decoded = for _ <- 1..@term_runs, do: Jason.decode!(term)
+        [reductions: r1, memory: m1] = :erlang.process_info(self(), [:reductions, :memory])
+
+        %{
+          heap_words: :erts_debug.size(term),
+          reductions: (r1 - r0) / @term_runs,
+          memory_bytes: (m1 - m0) / length(decoded)
+        }
+      end)
+
+    Task.await(task, :infinity)
+  end
+
+  defp percentile(values, p) do
+    sorted = Enum.sort(values)
+    Enum.at(sorted, min(round(p * length(sorted)), length(sorted) - 1))
+  end
+
+  defp dirty_utilization(before, after_sample) do
+    normal_count = :erlang.system_info(:schedulers)
+    dirty_count = :erlang.system_info(:dirty_cpu_schedulers)
+
+    {active, total} =
+      for {id, active1, total1} <- after_sample,
+          id > normal_count and id <= normal_count + dirty_count,
+          {^id, active0, total0} <- before,
+          reduce: {0, 0} do
+        {acc_a, acc_t} -> {acc_a + active1 - active0, acc_t + total1 - total0}
+      end
+
+    if total == 0, do: 0.0, else: active / total
+  end
+
+  defp result(scenario, params, metrics) do
+    %{scenario: scenario, params: params, metrics: metrics}
+  end
+
+  defp header(scenario), do: IO.puts("\n== #{scenario}")
+
+  defp row(label, metrics) do
+    values = Enum.map_join(metrics, "  ", fn {key, value} -> "#{key}=#{format(value)}" end)
+    IO.puts(String.pad_trailing(label, 32) <> values)
+  end
+
+  defp format(value) when is_float(value), do: :erlang.float_to_binary(value, decimals: 3)
+  defp format(value), do: to_string(value)
+
+  defp write_json(path, model_path, results) do
+    meta = %{
+      model: model_path,
+      otp_release: to_string(:erlang.system_info(:otp_release)),
+      schedulers: :erlang.system_info(:schedulers),
+      dirty_cpu_schedulers: :erlang.system_info(:dirty_cpu_schedulers),
+      system_architecture: to_string(:erlang.system_info(:system_architecture)),
+      timestamp: DateTime.to_iso8601(DateTime.utc_now())
+    }
+
+    File.write!(path, Jason.encode!(%{meta: meta, results: results}, pretty: true))
+    IO.puts("\nwrote #{path}")
+  end
+
+  defp compare(path, results) do
+    baseline =
+      path
+      |> File.read!()
+      |> Jason.decode!()
+      |> Map.fetch!("results")
+      |> Map.new(fn r -> {{r["scenario"], r["params"]}, r["metrics"]} end)
+
+    IO.puts("\n== change against #{path}")
+
+    for %{scenario: scenario, params: params, metrics: metrics} <- results,
+        old <- List.wrap(baseline[{scenario, stringify(params)}]) do
+      changes =
+        Enum.map_join(metrics, "  ", fn {key, value} ->
+          case old[to_string(key)] do
+            old_value when is_number(old_value) and old_value != 0 ->
+              "#{key}=#{format((value - old_value) / old_value * 100)}%"
+
+            _ ->
+              "#{key}=n/a"
+          end
+        end)
+
+      IO.puts(String.pad_trailing("#{scenario} #{inspect(params)}", 48) <> changes)
+    end
+  end
+
+  # JSON round trip turns param keys and atom values into strings
+  defp stringify(params) do
+    Map.new(params, fn {key, value} ->
+      {to_string(key), if(is_atom(value), do: to_string(value), else: value)}
+    end)
+  end
+end
+
+Bench.Suite.run(System.argv())
@@ -0,0 +1,51 @@
+#ifndef VOSK_CPU_H
+#define VOSK_CPU_H
+
+// Pulls in the libc feature macros (__GLIBC__) tested below
+#include <stdlib.h>
+
+// Runtime CPU dispatch for the native audio kernels. With VOSK_DISPATCH
+// defined (the Makefile default), GCC and Clang compile each VOSK_HOT
+// function once per target listed here, and an ifunc resolver picks the
+// best one for the CPU when the NIF is loaded. One build then runs AVX2 or
+// AVX-512 code where the CPU has it and still loads on baseline x86_64.
+// ifuncs need ELF and glibc; elsewhere the functions are built once, for
+// whatever target the compiler was given.
+//
+// NEON is part of the aarch64 baseline, so only SVE gets a clone there,
+// which GCC supports from version 14.
+#if defined(VOSK_DISPATCH) && defined(__linux__) && defined(__GLIBC__) && \
+    defined(__x86_64__) && (defined(__clang__) ? __clang_major__ >= 14 : __GNUC__ >= 6)
+#define VOSK_DISPATCH_X86 1
+#define VOSK_HOT __attribute__((target_clones("default", "avx2", "avx512f")))
+#define VOSK_DISPATCH_TARGETS {"default", "avx2", "avx512f"}
+#elif defined(VOSK_DISPATCH) && defined(__linux__) && defined(__GLIBC__) && \
+    defined(__aarch64__) && !defined(__clang__) && __GNUC__ >= 14
+#define VOSK_DISPATCH_ARM 1
+#define VOSK_HOT __attribute__((target_clones("default", "sve")))
+#define VOSK_DISPATCH_TARGETS {"default", "sve"}
+#include <sys/auxv.h>
+#else
+#define VOSK_HOT
+#define VOSK_DISPATCH_TARGETS {"default"}
+#endif
+
+// Clone the resolvers pick on this CPU, for VoskEx.build_info/0
+static inline const char* vosk_cpu_variant(void) {
+#if defined(VOSK_DISPATCH_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return "avx512f";
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return "avx2";
+    }
+#elif defined(VOSK_DISPATCH_ARM)
+    if (getauxval(AT_HWCAP) & HWCAP_SVE) {
+        return "sve";
+    }
+#endif
+    return "default";
+}
+
+#endif
@@ -0,0 +1,254 @@
+#include "vosk_dsp.h"
+#include "vosk_cpu.h"
+
+#include <erl_nif.h>
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Supported input range. The upsampling factor (output rate / gcd) bounds the
+// number of filter phases, so exotic rate pairs are rejected up front.
+#define DSP_MIN_RATE 1000
+#define DSP_MAX_RATE 384000
+#define DSP_MAX_CHANNELS 8
+#define DSP_MAX_PHASES 1024
+
+// Zero crossings of the sinc kept on each side of the filter centre
+#define DSP_ZERO_CROSSINGS 8
+
+// Cutoff as a fraction of the lower Nyquist frequency, leaving room for the
+// transition band so the stopband starts at Nyquist
+#define DSP_CUTOFF 0.9
+
+struct VoskDsp {
+    int channels;
+    int up;            // L: interpolation factor
+    int down;          // M: decimation factor
+    int taps;          // coefficients per phase
+    // up x taps coefficients. Each phase is stored reversed so the inner
+    // product walks coefficients and history in the same direction, which
+    // compilers vectorize without intrinsics (see dot below).
+    float* filter;
+    int phase;         // (n * M) mod L for the next output sample
+    size_t next;       // input index of the next output sample, in `work`
+    float* work;       // taps - 1 samples of history followed by new input
+    size_t work_cap;
+    float* out;
+    size_t out_cap;
+};
+
+static int gcd(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static int grow(float** buf, size_t* cap, size_t needed) {
+    if (needed <= *cap) {
+        return 1;
+    }
+    size_t cap_new = *cap == 0 ? 4096 : *cap;
+    while (cap_new < needed) {
+        cap_new *= 2;
+    }
+    float* grown = enif_realloc(*buf, cap_new * sizeof(float));
+    if (grown == NULL) {
+        return 0;
+    }
+    *buf = grown;
+    *cap = cap_new;
+    return 1;
+}
+
+// Low-pass prototype at the upsampled rate, Blackman windowed and split into
+// L reversed phases, each normalized to unity DC gain so the output level does
+// not ripple with the phase.
+static void design_filter(VoskDsp* dsp) {
+    int L = dsp->up;
+    int n = L * dsp->taps;
+    double cutoff = DSP_CUTOFF * 0.5 / (L > dsp->down ? L : dsp->down);
+    double centre = (n - 1) / 2.0;
+
+    for (int i = 0; i < n; i++) {
+        double t = i - centre;
+        double sinc = t == 0.0 ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * i / (n - 1)) +
+                        0.08 * cos(4.0 * M_PI * i / (n - 1));
+        // Coefficient i belongs to phase i % L, tap i / L
+        int phase = i % L;
+        int tap = i / L;
+        dsp->filter[phase * dsp->taps + (dsp->taps - 1 - tap)] = (float)(sinc * window);
+    }
+
+    for (int phase = 0; phase < L; phase++) {
+        float* h = dsp->filter + (size_t)phase * dsp->taps;
+        double sum = 0.0;
+        for (int k = 0; k < dsp->taps; k++) {
+            sum += h[k];
+        }
+        for (int k = 0; k < dsp->taps; k++) {
+            h[k] = (float)(h[k] / sum);
+        }
+    }
+}
+
+VoskDsp* vosk_dsp_create(int input_rate, int output_rate, int channels) {
+    if (input_rate < DSP_MIN_RATE || input_rate > DSP_MAX_RATE ||
+        output_rate < DSP_MIN_RATE || output_rate > DSP_MAX_RATE ||
+        channels < 1 || channels > DSP_MAX_CHANNELS) {
+        return NULL;
+    }
+
+    int g = gcd(input_rate, output_rate);
+    int up = output_rate / g;
+    int down = input_rate / g;
+    if (up > DSP_MAX_PHASES) {
+        return NULL;
+    }
+
+    VoskDsp* dsp = enif_alloc(sizeof(VoskDsp));
+    if (dsp == NULL) {
+        return NULL;
+    }
+    memset(dsp, 0, sizeof(VoskDsp));
+    dsp->channels = channels;
+    dsp->up = up;
+    dsp->down = down;
+
+    if (up == down) {
+        // Same rate: downmix only, a single unit tap
+        dsp->taps = 1;
+    } else {
+        int widest = up > down ? up : down;
+        dsp->taps = (2 * DSP_ZERO_CROSSINGS * widest + up - 1) / up;
+    }
+
+    dsp->filter = enif_alloc((size_t)up * dsp->taps * sizeof(float));
+    if (dsp->filter == NULL) {
+        enif_free(dsp);
+        return NULL;
+    }
+    if (dsp->taps == 1) {
+        dsp->filter[0] = 1.0f;
+    } else {
+        design_filter(dsp);
+    }
+
+    if (!grow(&dsp->work, &dsp->work_cap, (size_t)dsp->taps)) {
+        vosk_dsp_destroy(dsp);
+        return NULL;
+    }
+    vosk_dsp_reset(dsp);
+    return dsp;
+}
+
+void vosk_dsp_destroy(VoskDsp* dsp) {
+    if (dsp == NULL) {
+        return;
+    }
+    enif_free(dsp->filter);
+    if (dsp->work != NULL) {
+        enif_free(dsp->work);
+    }
+    if (dsp->out != NULL) {
+        enif_free(dsp->out);
+    }
+    enif_free(dsp);
+}
+
+void vosk_dsp_reset(VoskDsp* dsp) {
+    size_t history = (size_t)dsp->taps - 1;
+    memset(dsp->work, 0, history * sizeof(float));
+    dsp->phase = 0;
+    dsp->next = history;
+}
+
+size_t vosk_dsp_frame_bytes(const VoskDsp* dsp, int format) {
+    size_t sample = format == SAMPLE_FORMAT_F32LE ? sizeof(float) : sizeof(short);
+    return sample * (size_t)dsp->channels;
+}
+
+// Average interleaved frames into mono floats in the 16-bit range
+VOSK_HOT static void downmix(const VoskDsp* dsp, const unsigned char* data, size_t frames, int format,
+                    float* dst) {
+    int channels = dsp->channels;
+
+    if (format == SAMPLE_FORMAT_F32LE) {
+        float gain = 32768.0f / channels;
+        for (size_t i = 0; i < frames; i++) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; c++) {
+                float sample;
+                memcpy(&sample, data + (i * channels + c) * sizeof(float), sizeof(float));
+                sum += sample;
+            }
+            dst[i] = sum * gain;
+        }
+    } else {
+        float gain = 1.0f / channels;
+        for (size_t i = 0; i < frames; i++) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; c++) {
+                const unsigned char* p = data + (i * channels + c) * sizeof(short);
+                sum += (float)(short)(p[0] | (p[1] << 8));
+            }
+            dst[i] = sum * gain;
+        }
+    }
+}
+
+// Inner product of one filter phase with the history. The simd pragma lets
+// the compiler split the sum into vector lanes (it may not reorder float
+// additions on its own), so each VOSK_HOT clone uses its full vector width.
+VOSK_HOT static float dot(const float* h, const float* x, int taps) {
+    float acc = 0.0f;
+#pragma omp simd reduction(+:acc)
+    for (int k = 0; k < taps; k++) {
+        acc += h[k] * x[k];
+    }
+    return acc;
+}
+
+int vosk_dsp_process(VoskDsp* dsp, const unsigned char* data, size_t len, int format,
+                     const float** out) {
+    size_t frames = len / vosk_dsp_frame_bytes(dsp, format);
+    size_t history = (size_t)dsp->taps - 1;
+    size_t available = history + frames;
+
+    if (!grow(&dsp->work, &dsp->work_cap, available) ||
+        !grow(&dsp->out, &dsp->out_cap, frames * dsp->up / dsp->down + 1)) {
+        return -1;
+    }
+    downmix(dsp, data, frames, format, dsp->work + history);
+
+    // Output n reads inputs next - taps + 1 .. next of the work buffer with
+    // phase (n * M) mod L; both advance by M / L input samples per output
+    size_t count = 0;
+    size_t next = dsp->next;
+    int phase = dsp->phase;
+    int taps = dsp->taps;
+
+    while (next < available) {
+        const float* x = dsp->work + next - history;
+        const float* h = dsp->filter + (size_t)phase * taps;
+        dsp->out[count++] = dot(h, x, taps);
+
+        phase += dsp->down;
+        next += (size_t)(phase / dsp->up);
+        phase %= dsp->up;
+    }
+
+    // Keep the last taps - 1 inputs as history for the next chunk
+    memmove(dsp->work, dsp->work + available - history, history * sizeof(float));
+    dsp->next = next - (available - history);
+    dsp->phase = phase;
+
+    *out = dsp->out;
+    return (int)count;
+}
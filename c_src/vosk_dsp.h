@@ -0,0 +1,39 @@
+#ifndef VOSK_DSP_H
+#define VOSK_DSP_H
+
+#include <stddef.h>
+
+// Sample formats accepted by accept_waveform, matching VoskEx.Recognizer
+#define SAMPLE_FORMAT_S16LE 0
+#define SAMPLE_FORMAT_F32LE 1
+
+// Input conditioning stage for a recognizer: downmixes interleaved
+// multi-channel audio to mono and resamples it to the recognizer's rate with
+// a polyphase windowed-sinc filter. Filter history is kept between calls, so
+// a stream can be fed in chunks of any size.
+//
+// A stage is used by one recognizer at a time (under the recognizer lock) and
+// is not thread safe on its own.
+typedef struct VoskDsp VoskDsp;
+
+// Create a stage converting `channels` x `input_rate` Hz to mono at
+// `output_rate` Hz. Returns NULL if the rates or channel count are out of
+// range (see vosk_dsp.c) or on allocation failure.
+VoskDsp* vosk_dsp_create(int input_rate, int output_rate, int channels);
+
+void vosk_dsp_destroy(VoskDsp* dsp);
+
+// Drop filter history, as when a recognizer is reset
+void vosk_dsp_reset(VoskDsp* dsp);
+
+// Bytes per interleaved input frame in `format`
+size_t vosk_dsp_frame_bytes(const VoskDsp* dsp, int format);
+
+// Convert `len` bytes of interleaved samples. On success returns the number
+// of mono output samples and points *out at them, scaled to the 16-bit range
+// libvosk's float entry point expects. The buffer belongs to the stage and is
+// valid until the next call. Returns -1 on allocation failure.
+int vosk_dsp_process(VoskDsp* dsp, const unsigned char* data, size_t len, int format,
+                     const float** out);
+
+#endif
@@ -0,0 +1,746 @@
+#include "vosk_json.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Vosk results are shallow (result -> alternatives -> words), so this only
+// guards against runaway recursion on corrupt input.
+#define JSON_MAX_DEPTH 32
+
+// Object keys repeat for every word ("word", "start", "end", "conf"), so each
+// distinct key is built once per decode and the same term is reused.
+#define JSON_KEY_CACHE_SIZE 16
+
+typedef struct {
+    const char* name;
+    size_t len;
+    ERL_NIF_TERM term;
+} JsonKey;
+
+typedef struct {
+    ErlNifEnv* env;
+    const char* p;
+    const char* end;
+    int depth;
+    int flags;
+    JsonKey keys[JSON_KEY_CACHE_SIZE];
+    int key_count;
+} JsonParser;
+
+// Growable term buffer used while collecting array items and object members
+typedef struct {
+    ERL_NIF_TERM* items;
+    size_t count;
+    size_t capacity;
+} TermBuf;
+
+// Growable byte buffer used for packed columns
+typedef struct {
+    unsigned char* data;
+    size_t len;
+    size_t capacity;
+} ByteBuf;
+
+static int parse_value(JsonParser* ps, ERL_NIF_TERM* out);
+
+static int termbuf_push(TermBuf* buf, ERL_NIF_TERM term) {
+    if (buf->count == buf->capacity) {
+        size_t capacity = buf->capacity == 0 ? 8 : buf->capacity * 2;
+        ERL_NIF_TERM* items = enif_realloc(buf->items, capacity * sizeof(ERL_NIF_TERM));
+        if (items == NULL) {
+            return 0;
+        }
+        buf->items = items;
+        buf->capacity = capacity;
+    }
+    buf->items[buf->count++] = term;
+    return 1;
+}
+
+static void termbuf_free(TermBuf* buf) {
+    if (buf->items != NULL) {
+        enif_free(buf->items);
+    }
+}
+
+static void skip_ws(JsonParser* ps) {
+    while (ps->p < ps->end &&
+           (*ps->p == ' ' || *ps->p == '\n' || *ps->p == '\r' || *ps->p == '\t')) {
+        ps->p++;
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int parse_hex4(JsonParser* ps, unsigned* code) {
+    if (ps->end - ps->p < 4) {
+        return 0;
+    }
+    unsigned value = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hex_value(ps->p[i]);
+        if (digit < 0) {
+            return 0;
+        }
+        value = (value << 4) | (unsigned)digit;
+    }
+    ps->p += 4;
+    *code = value;
+    return 1;
+}
+
+static size_t encode_utf8(unsigned code, unsigned char* out) {
+    if (code < 0x80) {
+        out[0] = (unsigned char)code;
+        return 1;
+    } else if (code < 0x800) {
+        out[0] = (unsigned char)(0xC0 | (code >> 6));
+        out[1] = (unsigned char)(0x80 | (code & 0x3F));
+        return 2;
+    } else if (code < 0x10000) {
+        out[0] = (unsigned char)(0xE0 | (code >> 12));
+        out[1] = (unsigned char)(0x80 | ((code >> 6) & 0x3F));
+        out[2] = (unsigned char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    out[0] = (unsigned char)(0xF0 | (code >> 18));
+    out[1] = (unsigned char)(0x80 | ((code >> 12) & 0x3F));
+    out[2] = (unsigned char)(0x80 | ((code >> 6) & 0x3F));
+    out[3] = (unsigned char)(0x80 | (code & 0x3F));
+    return 4;
+}
+
+// Find the end of the string literal whose opening quote is at ps->p and
+// step past its closing quote. Returns 0 if it is unterminated.
+static int scan_string(JsonParser* ps, const char** start, const char** stop, int* has_escape) {
+    *start = ++ps->p;
+    *has_escape = 0;
+
+    while (ps->p < ps->end && *ps->p != '"') {
+        if (*ps->p == '\\') {
+            *has_escape = 1;
+            ps->p++;
+        }
+        ps->p++;
+    }
+    if (ps->p >= ps->end) {
+        return 0;
+    }
+
+    *stop = ps->p++;
+    return 1;
+}
+
+// Decode the escaped string body [start, stop) into dst, which must hold at
+// least stop - start bytes (decoded output is never longer than the input).
+static int unescape_into(JsonParser* ps, const char* start, const char* stop,
+                         unsigned char* dst, size_t* out_len) {
+    size_t len = 0;
+    const char* saved_p = ps->p;
+    const char* saved_end = ps->end;
+    ps->p = start;
+    ps->end = stop;
+
+    while (ps->p < ps->end) {
+        char c = *ps->p++;
+        if (c != '\\') {
+            dst[len++] = (unsigned char)c;
+            continue;
+        }
+
+        char esc = *ps->p++;
+        switch (esc) {
+            case '"':  dst[len++] = '"';  break;
+            case '\\': dst[len++] = '\\'; break;
+            case '/':  dst[len++] = '/';  break;
+            case 'b':  dst[len++] = '\b'; break;
+            case 'f':  dst[len++] = '\f'; break;
+            case 'n':  dst[len++] = '\n'; break;
+            case 'r':  dst[len++] = '\r'; break;
+            case 't':  dst[len++] = '\t'; break;
+            case 'u': {
+                unsigned code;
+                if (!parse_hex4(ps, &code)) {
+                    goto fail;
+                }
+                // Combine UTF-16 surrogate pairs into one code point
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    unsigned low;
+                    if (ps->end - ps->p < 6 || ps->p[0] != '\\' || ps->p[1] != 'u') {
+                        goto fail;
+                    }
+                    ps->p += 2;
+                    if (!parse_hex4(ps, &low) || low < 0xDC00 || low > 0xDFFF) {
+                        goto fail;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                len += encode_utf8(code, dst + len);
+                break;
+            }
+            default:
+                goto fail;
+        }
+    }
+
+    ps->p = saved_p;
+    ps->end = saved_end;
+    *out_len = len;
+    return 1;
+
+fail:
+    ps->p = saved_p;
+    ps->end = saved_end;
+    return 0;
+}
+
+// Parse a string literal (opening quote already at ps->p). Unescaped strings
+// are copied in one memcpy; escapes fall back to a byte-by-byte decode.
+static int parse_string(JsonParser* ps, ERL_NIF_TERM* out, int is_key) {
+    const char* start;
+    const char* stop;
+    int has_escape;
+
+    if (!scan_string(ps, &start, &stop, &has_escape)) {
+        return 0;
+    }
+    size_t raw_len = (size_t)(stop - start);
+
+    if (!has_escape) {
+        if (is_key) {
+            for (int i = 0; i < ps->key_count; i++) {
+                if (ps->keys[i].len == raw_len && memcmp(ps->keys[i].name, start, raw_len) == 0) {
+                    *out = ps->keys[i].term;
+                    return 1;
+                }
+            }
+        }
+
+        unsigned char* data = enif_make_new_binary(ps->env, raw_len, out);
+        memcpy(data, start, raw_len);
+
+        if (is_key && ps->key_count < JSON_KEY_CACHE_SIZE) {
+            JsonKey* key = &ps->keys[ps->key_count++];
+            key->name = start;
+            key->len = raw_len;
+            key->term = *out;
+        }
+        return 1;
+    }
+
+    ErlNifBinary bin;
+    size_t len;
+    if (!enif_alloc_binary(raw_len, &bin)) {
+        return 0;
+    }
+    if (!unescape_into(ps, start, stop, bin.data, &len) || !enif_realloc_binary(&bin, len)) {
+        enif_release_binary(&bin);
+        return 0;
+    }
+    *out = enif_make_binary(ps->env, &bin);
+    return 1;
+}
+
+// Copy the number literal at ps->p into buf as a C string
+static int scan_number(JsonParser* ps, char* buf, size_t size, int* is_float) {
+    const char* start = ps->p;
+    *is_float = 0;
+
+    if (ps->p < ps->end && *ps->p == '-') {
+        ps->p++;
+    }
+    while (ps->p < ps->end) {
+        char c = *ps->p;
+        if (c >= '0' && c <= '9') {
+            ps->p++;
+        } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+            *is_float = 1;
+            ps->p++;
+        } else {
+            break;
+        }
+    }
+
+    size_t len = (size_t)(ps->p - start);
+    if (len == 0 || len >= size) {
+        return 0;
+    }
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    return 1;
+}
+
+static int parse_number(JsonParser* ps, ERL_NIF_TERM* out) {
+    char buf[64];
+    int is_float;
+    if (!scan_number(ps, buf, sizeof(buf), &is_float)) {
+        return 0;
+    }
+
+    char* endptr;
+    errno = 0;
+    if (!is_float) {
+        long long value = strtoll(buf, &endptr, 10);
+        if (*endptr == '\0' && errno == 0) {
+            *out = enif_make_int64(ps->env, (ErlNifSInt64)value);
+            return 1;
+        }
+        errno = 0;
+    }
+
+    double value = strtod(buf, &endptr);
+    if (*endptr != '\0' || errno != 0) {
+        return 0;
+    }
+    *out = enif_make_double(ps->env, value);
+    return 1;
+}
+
+// Parse a number into a float
+static int parse_float(JsonParser* ps, float* out) {
+    char buf[64];
+    char* endptr;
+    int is_float;
+
+    if (!scan_number(ps, buf, sizeof(buf), &is_float)) {
+        return 0;
+    }
+    errno = 0;
+    double value = strtod(buf, &endptr);
+    if (*endptr != '\0' || errno != 0) {
+        return 0;
+    }
+    *out = (float)value;
+    return 1;
+}
+
+static void* bytebuf_reserve(ByteBuf* buf, size_t size) {
+    if (buf->len + size > buf->capacity) {
+        size_t capacity = buf->capacity == 0 ? 256 : buf->capacity;
+        while (capacity < buf->len + size) {
+            capacity *= 2;
+        }
+        unsigned char* data = enif_realloc(buf->data, capacity);
+        if (data == NULL) {
+            return NULL;
+        }
+        buf->data = data;
+        buf->capacity = capacity;
+    }
+    void* at = buf->data + buf->len;
+    buf->len += size;
+    return at;
+}
+
+static int bytebuf_append(ByteBuf* buf, const void* data, size_t size) {
+    void* at = bytebuf_reserve(buf, size);
+    if (at == NULL) {
+        return 0;
+    }
+    memcpy(at, data, size);
+    return 1;
+}
+
+static ERL_NIF_TERM bytebuf_to_binary(ErlNifEnv* env, const ByteBuf* buf) {
+    ERL_NIF_TERM term;
+    if (buf->len > 0) {
+        memcpy(enif_make_new_binary(env, buf->len, &term), buf->data, buf->len);
+    } else {
+        enif_make_new_binary(env, 0, &term);
+    }
+    return term;
+}
+
+static void bytebuf_free(ByteBuf* buf) {
+    if (buf->data != NULL) {
+        enif_free(buf->data);
+    }
+}
+
+// Parse an array of numbers into a binary of native-endian 32-bit floats.
+// Used for speaker vectors, which callers compare in bulk rather than read
+// one element at a time.
+static int parse_float_array(JsonParser* ps, ERL_NIF_TERM* out) {
+    ByteBuf items = {NULL, 0, 0};
+    ps->p++;
+    skip_ws(ps);
+
+    if (ps->p < ps->end && *ps->p == ']') {
+        ps->p++;
+        *out = bytebuf_to_binary(ps->env, &items);
+        return 1;
+    }
+
+    for (;;) {
+        float value;
+        skip_ws(ps);
+        if (!parse_float(ps, &value) || !bytebuf_append(&items, &value, sizeof(value))) {
+            goto fail;
+        }
+        skip_ws(ps);
+        if (ps->p >= ps->end) {
+            goto fail;
+        }
+        if (*ps->p == ',') {
+            ps->p++;
+            continue;
+        }
+        if (*ps->p == ']') {
+            ps->p++;
+            break;
+        }
+        goto fail;
+    }
+
+    *out = bytebuf_to_binary(ps->env, &items);
+    bytebuf_free(&items);
+    return 1;
+
+fail:
+    bytebuf_free(&items);
+    return 0;
+}
+
+// Word timing columns collected by parse_word_array
+typedef struct {
+    ByteBuf words;     // concatenated UTF-8 words
+    ByteBuf offsets;   // uint32 byte offset of every word, plus the total length
+    ByteBuf start;
+    ByteBuf end;
+    ByteBuf conf;
+    int has_conf;
+} WordColumns;
+
+static int key_is(const char* start, const char* stop, const char* name) {
+    size_t len = strlen(name);
+    return (size_t)(stop - start) == len && memcmp(start, name, len) == 0;
+}
+
+// Parse one {"word": ..., "start": ..., "end": ..., "conf": ...} object
+// straight into the columns. Other members are parsed and dropped.
+static int parse_word_object(JsonParser* ps, WordColumns* cols) {
+    float start = 0.0f, end = 0.0f, conf = 0.0f;
+
+    skip_ws(ps);
+    if (ps->p >= ps->end || *ps->p != '{') {
+        return 0;
+    }
+    ps->p++;
+    skip_ws(ps);
+    int empty = ps->p < ps->end && *ps->p == '}';
+    if (empty) {
+        ps->p++;
+    }
+
+    while (!empty) {
+        const char* key_start;
+        const char* key_stop;
+        int has_escape;
+
+        if (ps->p >= ps->end || *ps->p != '"' ||
+            !scan_string(ps, &key_start, &key_stop, &has_escape)) {
+            return 0;
+        }
+        skip_ws(ps);
+        if (ps->p >= ps->end || *ps->p != ':') {
+            return 0;
+        }
+        ps->p++;
+        skip_ws(ps);
+        if (ps->p >= ps->end) {
+            return 0;
+        }
+
+        int ok;
+        if (key_is(key_start, key_stop, "word") && *ps->p == '"') {
+            const char* word_start;
+            const char* word_stop;
+            ok = scan_string(ps, &word_start, &word_stop, &has_escape);
+            if (ok) {
+                size_t raw_len = (size_t)(word_stop - word_start);
+                size_t before = cols->words.len;
+                unsigned char* dst = bytebuf_reserve(&cols->words, raw_len);
+                size_t len = raw_len;
+                ok = dst != NULL;
+                if (ok && has_escape) {
+                    ok = unescape_into(ps, word_start, word_stop, dst, &len);
+                } else if (ok) {
+                    memcpy(dst, word_start, raw_len);
+                }
+                cols->words.len = before + len;
+            }
+        } else if (key_is(key_start, key_stop, "start")) {
+            ok = parse_float(ps, &start);
+        } else if (key_is(key_start, key_stop, "end")) {
+            ok = parse_float(ps, &end);
+        } else if (key_is(key_start, key_stop, "conf")) {
+            ok = parse_float(ps, &conf);
+            cols->has_conf = 1;
+        } else {
+            ERL_NIF_TERM ignored;
+            ok = parse_value(ps, &ignored);
+        }
+        skip_ws(ps);
+        if (!ok || ps->p >= ps->end) {
+            return 0;
+        }
+        if (*ps->p == ',') {
+            ps->p++;
+            skip_ws(ps);
+            continue;
+        }
+        if (*ps->p == '}') {
+            ps->p++;
+            break;
+        }
+        return 0;
+    }
+
+    uint32_t offset = (uint32_t)cols->words.len;
+    return bytebuf_append(&cols->offsets, &offset, sizeof(offset)) &&
+           bytebuf_append(&cols->start, &start, sizeof(start)) &&
+           bytebuf_append(&cols->end, &end, sizeof(end)) &&
+           bytebuf_append(&cols->conf, &conf, sizeof(conf));
+}
+
+// Parse a word list ("result" or "partial_result") into a
+// %VoskEx.WordTimings{} struct of packed columns instead of a list of maps
+static int parse_word_array(JsonParser* ps, ERL_NIF_TERM* out) {
+    WordColumns cols;
+    memset(&cols, 0, sizeof(cols));
+    uint32_t zero = 0;
+    int ok = bytebuf_append(&cols.offsets, &zero, sizeof(zero));
+
+    ps->p++;
+    skip_ws(ps);
+    if (ok && ps->p < ps->end && *ps->p == ']') {
+        ps->p++;
+    } else {
+        while (ok) {
+            ok = parse_word_object(ps, &cols);
+            skip_ws(ps);
+            if (!ok || ps->p >= ps->end) {
+                ok = 0;
+            } else if (*ps->p == ',') {
+                ps->p++;
+            } else if (*ps->p == ']') {
+                ps->p++;
+                break;
+            } else {
+                ok = 0;
+            }
+        }
+    }
+
+    if (ok) {
+        ErlNifEnv* env = ps->env;
+        ERL_NIF_TERM keys[6] = {
+            enif_make_atom(env, "__struct__"),
+            enif_make_atom(env, "words"),
+            enif_make_atom(env, "offsets"),
+            enif_make_atom(env, "start"),
+            enif_make_atom(env, "end"),
+            enif_make_atom(env, "conf"),
+        };
+        ERL_NIF_TERM values[6] = {
+            enif_make_atom(env, "Elixir.VoskEx.WordTimings"),
+            bytebuf_to_binary(env, &cols.words),
+            bytebuf_to_binary(env, &cols.offsets),
+            bytebuf_to_binary(env, &cols.start),
+            bytebuf_to_binary(env, &cols.end),
+            cols.has_conf ? bytebuf_to_binary(env, &cols.conf) : enif_make_atom(env, "nil"),
+        };
+        ok = enif_make_map_from_arrays(env, keys, values, 6, out);
+    }
+
+    bytebuf_free(&cols.words);
+    bytebuf_free(&cols.offsets);
+    bytebuf_free(&cols.start);
+    bytebuf_free(&cols.end);
+    bytebuf_free(&cols.conf);
+    return ok;
+}
+
+static int parse_literal(JsonParser* ps, const char* literal, ERL_NIF_TERM* out) {
+    size_t len = strlen(literal);
+    if ((size_t)(ps->end - ps->p) < len || memcmp(ps->p, literal, len) != 0) {
+        return 0;
+    }
+    ps->p += len;
+    *out = enif_make_atom(ps->env, strcmp(literal, "null") == 0 ? "nil" : literal);
+    return 1;
+}
+
+static int parse_array(JsonParser* ps, ERL_NIF_TERM* out) {
+    TermBuf items = {NULL, 0, 0};
+    ps->p++;
+    skip_ws(ps);
+
+    if (ps->p < ps->end && *ps->p == ']') {
+        ps->p++;
+        *out = enif_make_list(ps->env, 0);
+        return 1;
+    }
+
+    for (;;) {
+        ERL_NIF_TERM value;
+        if (!parse_value(ps, &value) || !termbuf_push(&items, value)) {
+            goto fail;
+        }
+        skip_ws(ps);
+        if (ps->p >= ps->end) {
+            goto fail;
+        }
+        if (*ps->p == ',') {
+            ps->p++;
+            continue;
+        }
+        if (*ps->p == ']') {
+            ps->p++;
+            break;
+        }
+        goto fail;
+    }
+
+    *out = enif_make_list_from_array(ps->env, items.items, (unsigned)items.count);
+    termbuf_free(&items);
+    return 1;
+
+fail:
+    termbuf_free(&items);
+    return 0;
+}
+
+static int parse_object(JsonParser* ps, ERL_NIF_TERM* out) {
+    TermBuf keys = {NULL, 0, 0};
+    TermBuf values = {NULL, 0, 0};
+    ps->p++;
+    skip_ws(ps);
+
+    if (ps->p < ps->end && *ps->p == '}') {
+        ps->p++;
+        *out = enif_make_new_map(ps->env);
+        return 1;
+    }
+
+    for (;;) {
+        ERL_NIF_TERM key, value;
+        skip_ws(ps);
+        if (ps->p >= ps->end || *ps->p != '"') {
+            goto fail;
+        }
+        const char* raw_key = ps->p + 1;
+        if (!parse_string(ps, &key, 1)) {
+            goto fail;
+        }
+        size_t raw_len = (size_t)(ps->p - raw_key) - 1;
+        skip_ws(ps);
+        if (ps->p >= ps->end || *ps->p != ':') {
+            goto fail;
+        }
+        ps->p++;
+        skip_ws(ps);
+        // Speaker vectors, and word lists when asked to, are packed instead
+        // of decoded as lists
+        int ok;
+        int is_array = ps->p < ps->end && *ps->p == '[';
+        if (is_array && key_is(raw_key, raw_key + raw_len, "spk")) {
+            ok = parse_float_array(ps, &value);
+        } else if (is_array && (ps->flags & VOSK_JSON_PACK_WORDS) &&
+                   (key_is(raw_key, raw_key + raw_len, "result") ||
+                    key_is(raw_key, raw_key + raw_len, "partial_result"))) {
+            ok = parse_word_array(ps, &value);
+        } else {
+            ok = parse_value(ps, &value);
+        }
+        if (!ok ||
+            !termbuf_push(&keys, key) ||
+            !termbuf_push(&values, value)) {
+            goto fail;
+        }
+        skip_ws(ps);
+        if (ps->p >= ps->end) {
+            goto fail;
+        }
+        if (*ps->p == ',') {
+            ps->p++;
+            continue;
+        }
+        if (*ps->p == '}') {
+            ps->p++;
+            break;
+        }
+        goto fail;
+    }
+
+    if (!enif_make_map_from_arrays(ps->env, keys.items, values.items, keys.count, out)) {
+        // Duplicate keys: keep the last value, as Jason does
+        ERL_NIF_TERM map = enif_make_new_map(ps->env);
+        for (size_t i = 0; i < keys.count; i++) {
+            enif_make_map_put(ps->env, map, keys.items[i], values.items[i], &map);
+        }
+        *out = map;
+    }
+
+    termbuf_free(&keys);
+    termbuf_free(&values);
+    return 1;
+
+fail:
+    termbuf_free(&keys);
+    termbuf_free(&values);
+    return 0;
+}
+
+static int parse_value(JsonParser* ps, ERL_NIF_TERM* out) {
+    skip_ws(ps);
+    if (ps->p >= ps->end) {
+        return 0;
+    }
+
+    int ok;
+    switch (*ps->p) {
+        case '{':
+        case '[':
+            if (++ps->depth > JSON_MAX_DEPTH) {
+                return 0;
+            }
+            ok = *ps->p == '{' ? parse_object(ps, out) : parse_array(ps, out);
+            ps->depth--;
+            return ok;
+        case '"':
+            return parse_string(ps, out, 0);
+        case 't':
+            return parse_literal(ps, "true", out);
+        case 'f':
+            return parse_literal(ps, "false", out);
+        case 'n':
+            return parse_literal(ps, "null", out);
+        default:
+            return parse_number(ps, out);
+    }
+}
+
+int vosk_json_decode(ErlNifEnv* env, const char* json, size_t len, int flags, ERL_NIF_TERM* out) {
+    JsonParser ps;
+    ps.env = env;
+    ps.p = json;
+    ps.end = json + len;
+    ps.depth = 0;
+    ps.flags = flags;
+    ps.key_count = 0;
+
+    if (!parse_value(&ps, out)) {
+        return 0;
+    }
+
+    skip_ws(&ps);
+    return ps.p == ps.end;
+}
@@ -0,0 +1,28 @@
+#ifndef VOSK_JSON_H
+#define VOSK_JSON_H
+
+#include <erl_nif.h>
+
+#define VOSK_JSON_PACK_WORDS 1
+
+// Decode a libvosk JSON result straight into Erlang terms.
+//
+// Objects become maps with binary keys, arrays become lists, strings become
+// binaries, numbers become integers or floats (floats when the literal has a
+// fraction or exponent), and true/false/null become atoms. This mirrors the
+// shape Jason produces, so callers can switch decoders without code changes.
+// The one exception is the speaker vector under "spk", which becomes a binary
+// of native-endian 32-bit floats (VoskEx.Recognizer packs Jason output the
+// same way).
+//
+// With VOSK_JSON_PACK_WORDS in flags, word lists ("result" and
+// "partial_result") become %VoskEx.WordTimings{} structs of packed columns:
+// concatenated UTF-8 words, uint32 offsets (word i spans offsets[i] up to
+// offsets[i + 1]) and 32-bit float start, end and conf binaries, all
+// native-endian.
+// conf is nil when the words carry no confidence, as in alternatives.
+//
+// Returns 1 and stores the term in *out on success, 0 on malformed input.
+int vosk_json_decode(ErlNifEnv* env, const char* json, size_t len, int flags, ERL_NIF_TERM* out);
+
+#endif
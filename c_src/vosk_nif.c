@@ -1,35 +1,399 @@
+// realpath() is POSIX/XSI, not C11
+#define _XOPEN_SOURCE 700
+
 #include <erl_nif.h>
 #include <vosk_api.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "vosk_cpu.h"
+#include "vosk_dsp.h"
+#include "vosk_json.h"
+#include "vosk_vad.h"
+#include "vosk_vocab.h"
 
 // Resource types
 static ErlNifResourceType* MODEL_TYPE;
 static ErlNifResourceType* RECOGNIZER_TYPE;
+static ErlNifResourceType* BATCH_MODEL_TYPE;
+static ErlNifResourceType* BATCH_RECOGNIZER_TYPE;
+static ErlNifResourceType* AUDIO_BUFFER_TYPE;
+static ErlNifResourceType* SPK_MODEL_TYPE;
+static ErlNifResourceType* VOCABULARY_TYPE;
+
+// Word list of a model, read on first use. Binaries returned by
+// `vocabulary` point into it, so it outlives the model while they do.
+typedef struct {
+    char* data;
+    size_t len;
+} VocabularyResource;
+
+// One loaded model directory, shared by every handle loaded from the same
+// canonical path. Guarded by model_registry.lock.
+typedef struct ModelEntry {
+    char* path;                // canonical path, allocated with enif_alloc
+    VoskModel* model;          // NULL while the first load is in progress
+    int handles;               // live ModelResource handles
+    int loading;
+    ErlNifUInt64 files_bytes;  // size of the directory's files, measured at load
+    VocabularyResource* vocabulary;  // kept resource, NULL until read
+    int vocabulary_missing;          // no word list found in the directory
+    struct ModelEntry* next;
+} ModelEntry;
+
+// Registry of loaded models. Loads of a path that is loaded, or being
+// loaded, share one VoskModel; it is freed when the last handle is collected.
+static struct {
+    ErlNifMutex* lock;
+    ErlNifCond* cond;          // signalled when a load finishes
+    ModelEntry* entries;
+} model_registry;
 
 // Resource structures
 typedef struct {
     VoskModel* model;
+    ModelEntry* entry;
 } ModelResource;
 
+// Speaker identification model. libvosk reference-counts it, so recognizers
+// created with it stay valid after the resource is collected.
+typedef struct {
+    VoskSpkModel* model;
+} SpkModelResource;
+
+typedef struct AsyncJob AsyncJob;
+
+// Cumulative decoding counters, kept per recognizer and for the whole node
 typedef struct {
+    ErlNifUInt64 samples;        // mono samples fed, at the recognizer's rate
+    ErlNifUInt64 native_ns;      // time spent in libvosk and the input stage
+    ErlNifUInt64 utterances;     // utterance and final results fetched
+    ErlNifUInt64 result_bytes;   // result JSON produced by libvosk
+} VoskCounters;
+
+static void counters_add(VoskCounters* to, const VoskCounters* from) {
+    to->samples += from->samples;
+    to->native_ns += from->native_ns;
+    to->utterances += from->utterances;
+    to->result_bytes += from->result_bytes;
+}
+
+// Node-wide totals for the stats NIF. `totals` includes collected
+// recognizers; created - destroyed is the number still alive, so handles
+// that are never collected show up as a growing live count. Recognizers run
+// at different rates, so the audio fed is also summed in seconds.
+// A mutex rather than atomics: the NIF also builds with MSVC's C compiler,
+// which has no C11 atomics, and the lock is taken once per NIF call.
+static struct {
+    ErlNifMutex* lock;
+    ErlNifUInt64 created;
+    ErlNifUInt64 destroyed;
+    VoskCounters totals;
+    double audio_seconds;
+} recognizer_stats;
+
+typedef struct RecognizerResource {
     VoskRecognizer* recognizer;
+    // Held for the duration of every libvosk call on this recognizer. NIFs
+    // only try-lock it, so concurrent use returns {:error, :busy}.
+    ErlNifMutex* lock;
+    // Set under `lock` while a split accept_waveform owns the recognizer
+    // between slices, since the lock cannot be held across a reschedule.
+    // NIFs treat it like a held lock; the async workers wait on `released`.
+    // The owner is monitored so a caller killed between slices does not
+    // leave the recognizer claimed.
+    int claimed;
+    ErlNifMonitor owner;
+    ErlNifCond* released;
+    // Rate the recognizer was created for, and the optional downmix/resample
+    // stage converting input audio to it (NULL when audio is fed as-is)
+    float sample_rate;
+    VoskDsp* dsp;
+    // Optional silence gate after the input stage (NULL when disabled). While
+    // set, audio always goes through `dsp`, created as a plain converter if
+    // no resampling is needed.
+    VoskVad* vad;
+    // Optional endpointer on the same audio (NULL when disabled). When it
+    // ends an utterance libvosk has not ended, ep_forced is set and the
+    // utterance result is taken with vosk_recognizer_final_result, which
+    // finishes it and lets the next audio start a new one.
+    VoskEndpointer* endpointer;
+    int ep_forced;
+    // Last partial result JSON handed out with "only if changed" semantics,
+    // so repeated identical hypotheses can be answered with :unchanged
+    // (NULL when none is remembered)
+    char* last_partial;
+    // Audio fed since the last utterance result, as s16le at sample_rate
+    // before the silence gate, so checkpoint_nif can hand the utterance in
+    // progress to another recognizer (libvosk cannot serialize its decoder).
+    // Only kept once enable_checkpoints sets tail_max, in bytes; an utterance
+    // that outgrows it sets tail_overflow until the next result. `position`
+    // counts the samples fed since creation and tail_start is where the tail
+    // begins. Word times of a recognizer restored from a checkpoint are
+    // shifted by time_shift samples, so they continue the original timeline.
+    unsigned char* tail;
+    size_t tail_len;
+    size_t tail_cap;
+    size_t tail_max;
+    int tail_overflow;
+    ErlNifUInt64 position;
+    ErlNifUInt64 tail_start;
+    ErlNifSInt64 time_shift;
+    // Result settings, recorded for checkpoints
+    int words;
+    int partial_words;
+    int max_alternatives;
+    // Native time spent in libvosk (and the input stage) by the last call that
+    // claimed the recognizer, and the audio it fed in samples at sample_rate,
+    // for telemetry, plus the counters of every call so far. Guarded by
+    // stats_lock, which is only held for a few stores, so readers never wait
+    // on a running decode.
+    ErlNifMutex* stats_lock;
+    ErlNifUInt64 call_ns;
+    ErlNifUInt64 call_samples;
+    VoskCounters counters;
+    // Async engine state, guarded by async_pool.lock
+    AsyncJob* jobs_head;
+    AsyncJob* jobs_tail;
+    int scheduled;                       // queued on, or running in, the pool
+    struct RecognizerResource* next_ready;
 } RecognizerResource;
 
+// One queued accept_waveform_async call. The audio binary lives in `env`,
+// so refc binaries are shared rather than copied.
+struct AsyncJob {
+    ErlNifEnv* env;
+    ErlNifBinary audio;
+    ErlNifPid reply_to;
+    AsyncJob* next;
+};
+
+// Native worker pool for accept_waveform_async. Recognizers with queued jobs
+// sit on the ready list; a worker takes one recognizer at a time, so each
+// recognizer's jobs run in order and never concurrently.
+static struct {
+    ErlNifMutex* lock;
+    ErlNifCond* cond;
+    ErlNifTid* threads;
+    int size;            // configured thread count, 0 = one per scheduler
+    int started;
+    int running;
+    RecognizerResource* ready_head;
+    RecognizerResource* ready_tail;
+} async_pool;
+
+typedef struct BatchRecognizerResource BatchRecognizerResource;
+
+// Batch decoding state shared between a batch model and its worker thread.
+// All vosk_batch_* calls except vosk_batch_model_wait happen under `lock`.
+typedef struct {
+    VoskBatchModel* model;
+    ErlNifMutex* lock;
+    ErlNifCond* cond;
+    ErlNifTid thread;
+    ErlNifEnv* msg_env;
+    BatchRecognizerResource* recognizers;  // intrusive list of live recognizers
+    int running;
+    int has_work;
+} BatchEngine;
+
+typedef struct {
+    BatchEngine* engine;
+} BatchModelResource;
+
+struct BatchRecognizerResource {
+    VoskBatchRecognizer* recognizer;
+    BatchModelResource* model;  // kept so the engine outlives its recognizers
+    ErlNifPid owner;
+    ErlNifEnv* tag_env;
+    ERL_NIF_TERM tag;           // caller-chosen term identifying result messages
+    int finished;
+    int drained;                // waited on the pipeline after finishing
+    int done_sent;
+    BatchRecognizerResource* next;
+};
+
+// Native audio ring buffer feeding one recognizer. Producers append under
+// `lock` and never touch unread bytes, so the decoder feeds libvosk straight
+// from the ring after releasing `lock`; only one drain runs at a time since
+// draining holds the recognizer lock.
+typedef struct {
+    RecognizerResource* recognizer;  // kept for the buffer's lifetime
+    ErlNifMutex* lock;
+    unsigned char* data;
+    size_t capacity;     // a multiple of block
+    size_t block;        // bytes decoded per step
+    size_t head;         // offset of the oldest unread byte
+    size_t count;        // unread bytes
+    int format;
+    int notify;          // send a ready message to notify_pid
+    ErlNifPid notify_pid;
+    ErlNifUInt64 overflows;
+} AudioBufferResource;
+
 // Resource destructors
 static void model_destructor(ErlNifEnv* env, void* obj) {
     ModelResource* res = (ModelResource*)obj;
+    ModelEntry* entry = res->entry;
+    if (entry == NULL) {
+        return;
+    }
+
+    enif_mutex_lock(model_registry.lock);
+    int last = --entry->handles == 0;
+    if (last) {
+        ModelEntry** link = &model_registry.entries;
+        while (*link != entry) {
+            link = &(*link)->next;
+        }
+        *link = entry->next;
+    }
+    enif_mutex_unlock(model_registry.lock);
+
+    if (last) {
+        // Recognizers hold their own reference inside libvosk
+        vosk_model_free(entry->model);
+        if (entry->vocabulary != NULL) {
+            enif_release_resource(entry->vocabulary);
+        }
+        enif_free(entry->path);
+        enif_free(entry);
+    }
+    res->model = NULL;
+    res->entry = NULL;
+}
+
+static void vocabulary_destructor(ErlNifEnv* env, void* obj) {
+    VocabularyResource* res = (VocabularyResource*)obj;
+    if (res->data != NULL) {
+        enif_free(res->data);
+        res->data = NULL;
+    }
+}
+
+static void spk_model_destructor(ErlNifEnv* env, void* obj) {
+    SpkModelResource* res = (SpkModelResource*)obj;
     if (res->model != NULL) {
-        vosk_model_free(res->model);
+        vosk_spk_model_free(res->model);
         res->model = NULL;
     }
 }
 
 static void recognizer_destructor(ErlNifEnv* env, void* obj) {
     RecognizerResource* res = (RecognizerResource*)obj;
+    // Only recognizers that make_recognizer_resource handed out were counted
+    if (res->lock != NULL && res->stats_lock != NULL) {
+        enif_mutex_lock(recognizer_stats.lock);
+        recognizer_stats.destroyed++;
+        enif_mutex_unlock(recognizer_stats.lock);
+    }
     if (res->recognizer != NULL) {
         vosk_recognizer_free(res->recognizer);
         res->recognizer = NULL;
     }
+    if (res->lock != NULL) {
+        enif_mutex_destroy(res->lock);
+        res->lock = NULL;
+    }
+    if (res->stats_lock != NULL) {
+        enif_mutex_destroy(res->stats_lock);
+        res->stats_lock = NULL;
+    }
+    if (res->released != NULL) {
+        enif_cond_destroy(res->released);
+        res->released = NULL;
+    }
+    if (res->dsp != NULL) {
+        vosk_dsp_destroy(res->dsp);
+        res->dsp = NULL;
+    }
+    if (res->vad != NULL) {
+        vosk_vad_destroy(res->vad);
+        res->vad = NULL;
+    }
+    if (res->endpointer != NULL) {
+        vosk_endpointer_destroy(res->endpointer);
+        res->endpointer = NULL;
+    }
+    if (res->last_partial != NULL) {
+        enif_free(res->last_partial);
+        res->last_partial = NULL;
+    }
+    if (res->tail != NULL) {
+        enif_free(res->tail);
+        res->tail = NULL;
+    }
+}
+
+static void batch_model_destructor(ErlNifEnv* env, void* obj) {
+    BatchModelResource* res = (BatchModelResource*)obj;
+    BatchEngine* engine = res->engine;
+    if (engine == NULL) {
+        return;
+    }
+
+    // Recognizers keep the model alive, so the list is empty by now
+    enif_mutex_lock(engine->lock);
+    engine->running = 0;
+    enif_cond_signal(engine->cond);
+    enif_mutex_unlock(engine->lock);
+    enif_thread_join(engine->thread, NULL);
+
+    vosk_batch_model_free(engine->model);
+    enif_free_env(engine->msg_env);
+    enif_cond_destroy(engine->cond);
+    enif_mutex_destroy(engine->lock);
+    enif_free(engine);
+    res->engine = NULL;
+}
+
+static void batch_recognizer_destructor(ErlNifEnv* env, void* obj) {
+    BatchRecognizerResource* res = (BatchRecognizerResource*)obj;
+    if (res->model == NULL) {
+        return;
+    }
+
+    BatchEngine* engine = res->model->engine;
+    enif_mutex_lock(engine->lock);
+    BatchRecognizerResource** link = &engine->recognizers;
+    while (*link != NULL && *link != res) {
+        link = &(*link)->next;
+    }
+    if (*link == res) {
+        *link = res->next;
+    }
+    if (res->recognizer != NULL) {
+        vosk_batch_recognizer_free(res->recognizer);
+        res->recognizer = NULL;
+    }
+    enif_mutex_unlock(engine->lock);
+
+    enif_free_env(res->tag_env);
+    enif_release_resource(res->model);
+    res->model = NULL;
+}
+
+static void audio_buffer_destructor(ErlNifEnv* env, void* obj) {
+    AudioBufferResource* res = (AudioBufferResource*)obj;
+    if (res->data != NULL) {
+        enif_free(res->data);
+        res->data = NULL;
+    }
+    if (res->lock != NULL) {
+        enif_mutex_destroy(res->lock);
+        res->lock = NULL;
+    }
+    if (res->recognizer != NULL) {
+        enif_release_resource(res->recognizer);
+        res->recognizer = NULL;
+    }
 }
 
 // Helper function to make error tuples
@@ -39,6 +403,120 @@ static ERL_NIF_TERM make_error(ErlNifEnv* env, const char* reason) {
         enif_make_atom(env, reason));
 }
 
+// Helper function to copy a binary into a NUL-terminated heap string.
+// Used for arguments with no sensible fixed bound (grammars); free with enif_free.
+static char* alloc_cstring(const ErlNifBinary* bin) {
+    char* str = enif_alloc(bin->size + 1);
+    if (str != NULL) {
+        memcpy(str, bin->data, bin->size);
+        str[bin->size] = '\0';
+    }
+    return str;
+}
+
+// Helper function to copy a libvosk JSON string into a binary term.
+// Binaries avoid building one cons cell per byte as enif_make_string does.
+static ERL_NIF_TERM make_json_binary(ErlNifEnv* env, const char* json) {
+    ERL_NIF_TERM term;
+    size_t len = json != NULL ? strlen(json) : 0;
+    unsigned char* data = enif_make_new_binary(env, len, &term);
+    if (len > 0) {
+        memcpy(data, json, len);
+    }
+    return term;
+}
+
+// Wrap a new libvosk recognizer in a resource term, or free it on failure
+static ERL_NIF_TERM make_recognizer_resource(ErlNifEnv* env, VoskRecognizer* rec, float sample_rate) {
+    RecognizerResource* res = enif_alloc_resource(RECOGNIZER_TYPE, sizeof(RecognizerResource));
+    memset(res, 0, sizeof(RecognizerResource));
+    res->recognizer = rec;
+    res->sample_rate = sample_rate;
+    res->lock = enif_mutex_create("vosk_recognizer_lock");
+    res->stats_lock = enif_mutex_create("vosk_recognizer_stats_lock");
+    res->released = enif_cond_create("vosk_recognizer_released");
+    if (res->lock == NULL || res->stats_lock == NULL || res->released == NULL) {
+        enif_release_resource(res);
+        return make_error(env, "out_of_memory");
+    }
+
+    enif_mutex_lock(recognizer_stats.lock);
+    recognizer_stats.created++;
+    enif_mutex_unlock(recognizer_stats.lock);
+
+    ERL_NIF_TERM term = enif_make_resource(env, res);
+    enif_release_resource(res);
+
+    return enif_make_tuple2(env, enif_make_atom(env, "ok"), term);
+}
+
+// Start a new call for the timing reported by last_call_stats
+static void recognizer_start_call(RecognizerResource* res) {
+    enif_mutex_lock(res->stats_lock);
+    res->call_ns = 0;
+    res->call_samples = 0;
+    enif_mutex_unlock(res->stats_lock);
+}
+
+// Claim a recognizer for one libvosk call. Uncontended this is a single
+// try-lock; a recognizer already in use by another call is reported as busy.
+static int recognizer_acquire(RecognizerResource* res) {
+    if (enif_mutex_trylock(res->lock) != 0) {
+        return 0;
+    }
+    if (res->claimed) {
+        enif_mutex_unlock(res->lock);
+        return 0;
+    }
+    recognizer_start_call(res);
+    return 1;
+}
+
+// recognizer_acquire for the async workers, which are off the schedulers
+// and so wait for a call in progress instead of failing
+static void recognizer_acquire_wait(RecognizerResource* res) {
+    enif_mutex_lock(res->lock);
+    while (res->claimed) {
+        enif_cond_wait(res->released, res->lock);
+    }
+    recognizer_start_call(res);
+}
+
+// Keep the recognizer for the calling process across a reschedule. Caller
+// holds the lock. Returns 0 if the caller could not be monitored.
+static int recognizer_claim(ErlNifEnv* env, RecognizerResource* res) {
+    ErlNifPid self;
+    if (enif_self(env, &self) == NULL ||
+        enif_monitor_process(env, res, &self, &res->owner) != 0) {
+        return 0;
+    }
+    res->claimed = 1;
+    return 1;
+}
+
+// End a claim. Caller holds the lock.
+static void recognizer_unclaim(ErlNifEnv* env, RecognizerResource* res) {
+    if (env != NULL) {
+        enif_demonitor_process(env, res, &res->owner);
+    }
+    res->claimed = 0;
+    enif_cond_broadcast(res->released);
+}
+
+// The owner of a claim exited before its last slice ran
+static void recognizer_down(ErlNifEnv* env, void* obj, ErlNifPid* pid, ErlNifMonitor* mon) {
+    RecognizerResource* res = (RecognizerResource*)obj;
+    enif_mutex_lock(res->lock);
+    if (res->claimed && enif_compare_monitors(mon, &res->owner) == 0) {
+        recognizer_unclaim(NULL, res);
+    }
+    enif_mutex_unlock(res->lock);
+}
+
+static void recognizer_release(RecognizerResource* res) {
+    enif_mutex_unlock(res->lock);
+}
+
 // Set log level
 static ERL_NIF_TERM set_log_level_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     int level;
@@ -50,7 +528,78 @@ static ERL_NIF_TERM set_log_level_nif(ErlNifEnv* env, int argc, const ERL_NIF_TE
     return enif_make_atom(env, "ok");
 }
 
-// Load model
+// Total size of the regular files under `path`. libvosk reads the acoustic
+// model, graphs and rescoring data into memory, so this is a fair estimate of
+// what a loaded model holds. `depth` bounds the walk against symlink loops.
+static ErlNifUInt64 files_size(const char* path, int depth) {
+    ErlNifUInt64 total = 0;
+    size_t len = strlen(path);
+    if (depth > 16) {
+        return 0;
+    }
+
+#ifdef _WIN32
+    char* pattern = enif_alloc(len + 3);
+    if (pattern == NULL) {
+        return 0;
+    }
+    memcpy(pattern, path, len);
+    strcpy(pattern + len, "\\*");
+
+    WIN32_FIND_DATAA found;
+    HANDLE dir = FindFirstFileA(pattern, &found);
+    enif_free(pattern);
+    if (dir == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    do {
+        if (strcmp(found.cFileName, ".") == 0 || strcmp(found.cFileName, "..") == 0) {
+            continue;
+        }
+        if (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            char* child = enif_alloc(len + strlen(found.cFileName) + 2);
+            if (child != NULL) {
+                sprintf(child, "%s\\%s", path, found.cFileName);
+                total += files_size(child, depth + 1);
+                enif_free(child);
+            }
+        } else {
+            total += ((ErlNifUInt64)found.nFileSizeHigh << 32) | found.nFileSizeLow;
+        }
+    } while (FindNextFileA(dir, &found));
+    FindClose(dir);
+#else
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        return 0;
+    }
+    struct dirent* item;
+    while ((item = readdir(dir)) != NULL) {
+        if (strcmp(item->d_name, ".") == 0 || strcmp(item->d_name, "..") == 0) {
+            continue;
+        }
+        char* child = enif_alloc(len + strlen(item->d_name) + 2);
+        if (child == NULL) {
+            continue;
+        }
+        sprintf(child, "%s/%s", path, item->d_name);
+
+        struct stat info;
+        if (stat(child, &info) == 0) {
+            if (S_ISDIR(info.st_mode)) {
+                total += files_size(child, depth + 1);
+            } else if (S_ISREG(info.st_mode)) {
+                total += (ErlNifUInt64)info.st_size;
+            }
+        }
+        enif_free(child);
+    }
+    closedir(dir);
+#endif
+    return total;
+}
+
+// Load model (dirty IO NIF: reads and parses the model files from disk)
 static ERL_NIF_TERM load_model_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     ErlNifBinary path_bin;
     if (!enif_inspect_binary(env, argv[0], &path_bin)) {
@@ -65,13 +614,86 @@ static ERL_NIF_TERM load_model_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM
     memcpy(path, path_bin.data, path_bin.size);
     path[path_bin.size] = '\0';
 
-    VoskModel* model = vosk_model_new(path);
-    if (model == NULL) {
+    // The registry key: relative paths, "..", and (on POSIX) symlinks to the
+    // same directory all resolve to one entry
+#ifdef _WIN32
+    char* canonical = _fullpath(NULL, path, 0);
+#else
+    char* canonical = realpath(path, NULL);
+#endif
+    if (canonical == NULL) {
         return make_error(env, "model_load_failed");
     }
 
+    enif_mutex_lock(model_registry.lock);
+    ModelEntry* entry;
+    for (;;) {
+        entry = model_registry.entries;
+        while (entry != NULL && strcmp(entry->path, canonical) != 0) {
+            entry = entry->next;
+        }
+        if (entry == NULL || !entry->loading) {
+            break;
+        }
+        // Another caller is loading this path; share its result
+        enif_cond_wait(model_registry.cond, model_registry.lock);
+    }
+
+    if (entry == NULL) {
+        entry = enif_alloc(sizeof(ModelEntry));
+        char* key = entry != NULL ? enif_alloc(strlen(canonical) + 1) : NULL;
+        if (key == NULL) {
+            enif_mutex_unlock(model_registry.lock);
+            if (entry != NULL) {
+                enif_free(entry);
+            }
+            free(canonical);
+            return make_error(env, "out_of_memory");
+        }
+        strcpy(key, canonical);
+        entry->path = key;
+        entry->model = NULL;
+        entry->handles = 0;
+        entry->loading = 1;
+        entry->files_bytes = 0;
+        entry->vocabulary = NULL;
+        entry->vocabulary_missing = 0;
+        entry->next = model_registry.entries;
+        model_registry.entries = entry;
+        enif_mutex_unlock(model_registry.lock);
+
+        VoskModel* model = vosk_model_new(canonical);
+        // Measured once here, so stats never walk the directory
+        ErlNifUInt64 files_bytes = model != NULL ? files_size(canonical, 0) : 0;
+
+        enif_mutex_lock(model_registry.lock);
+        entry->loading = 0;
+        entry->model = model;
+        entry->files_bytes = files_bytes;
+        enif_cond_broadcast(model_registry.cond);
+
+        if (model == NULL) {
+            // Waiters see no entry and try the load themselves
+            ModelEntry** link = &model_registry.entries;
+            while (*link != entry) {
+                link = &(*link)->next;
+            }
+            *link = entry->next;
+            enif_mutex_unlock(model_registry.lock);
+            enif_free(entry->path);
+            enif_free(entry);
+            free(canonical);
+            return make_error(env, "model_load_failed");
+        }
+    }
+    free(canonical);
+
+    entry->handles++;
+    enif_mutex_unlock(model_registry.lock);
+
     ModelResource* res = enif_alloc_resource(MODEL_TYPE, sizeof(ModelResource));
-    res->model = model;
+    res->model = entry->model;
+    res->entry = entry;
 
     ERL_NIF_TERM term = enif_make_resource(env, res);
     enif_release_resource(res);
@@ -79,6 +701,58 @@ static ERL_NIF_TERM load_model_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM
     return enif_make_tuple2(env, enif_make_atom(env, "ok"), term);
 }
 
+// List loaded models as [%{path: binary, handles: integer}]
+static ERL_NIF_TERM loaded_models_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    ERL_NIF_TERM list = enif_make_list(env, 0);
+    ERL_NIF_TERM keys[3] = {
+        enif_make_atom(env, "path"),
+        enif_make_atom(env, "handles"),
+        enif_make_atom(env, "files_bytes")
+    };
+
+    enif_mutex_lock(model_registry.lock);
+    for (ModelEntry* entry = model_registry.entries; entry != NULL; entry = entry->next) {
+        if (entry->loading) {
+            continue;
+        }
+        ERL_NIF_TERM values[3];
+        size_t len = strlen(entry->path);
+        memcpy(enif_make_new_binary(env, len, &values[0]), entry->path, len);
+        values[1] = enif_make_int(env, entry->handles);
+        values[2] = enif_make_uint64(env, entry->files_bytes);
+
+        ERL_NIF_TERM map;
+        enif_make_map_from_arrays(env, keys, values, 3, &map);
+        list = enif_make_list_cell(env, map, list);
+    }
+    enif_mutex_unlock(model_registry.lock);
+
+    return list;
+}
+
+// Look up one word, null-terminating it on the stack or, if it is long, on
+// the heap. Returns -1 if not found (a word with a NUL byte never is) and
+// -2 on allocation failure.
+static int model_find_word(VoskModel* model, const ErlNifBinary* word_bin) {
+    if (memchr(word_bin->data, '\0', word_bin->size) != NULL) {
+        return -1;
+    }
+
+    char stack_word[256];
+    char* word = word_bin->size < sizeof(stack_word) ? stack_word : enif_alloc(word_bin->size + 1);
+    if (word == NULL) {
+        return -2;
+    }
+    memcpy(word, word_bin->data, word_bin->size);
+    word[word_bin->size] = '\0';
+
+    int result = vosk_model_find_word(model, word);
+    if (word != stack_word) {
+        enif_free(word);
+    }
+    return result;
+}
+
 // Find word in model
 static ERL_NIF_TERM find_word_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     ModelResource* model_res;
@@ -89,19 +763,109 @@ static ERL_NIF_TERM find_word_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM a
         return enif_make_badarg(env);
     }
 
-    // Ensure null termination
-    char word[256];
-    if (word_bin.size >= sizeof(word)) {
+    int result = model_find_word(model_res->model, &word_bin);
+    if (result == -2) {
+        return make_error(env, "out_of_memory");
+    }
+    return enif_make_int(env, result);
+}
+
+// Find a list of words in one call (dirty CPU NIF: lists can have tens of
+// thousands of entries). Returns their symbols in list order.
+static ERL_NIF_TERM find_words_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    ModelResource* model_res;
+    unsigned count;
+
+    if (!enif_get_resource(env, argv[0], MODEL_TYPE, (void**)&model_res) ||
+        !enif_get_list_length(env, argv[1], &count)) {
         return enif_make_badarg(env);
     }
-    memcpy(word, word_bin.data, word_bin.size);
-    word[word_bin.size] = '\0';
 
-    int result = vosk_model_find_word(model_res->model, word);
-    return enif_make_int(env, result);
+    ERL_NIF_TERM* symbols = enif_alloc((count > 0 ? count : 1) * sizeof(ERL_NIF_TERM));
+    if (symbols == NULL) {
+        return make_error(env, "out_of_memory");
+    }
+
+    ERL_NIF_TERM list = argv[1], head;
+    for (unsigned i = 0; i < count; i++) {
+        ErlNifBinary word_bin;
+        enif_get_list_cell(env, list, &head, &list);
+        if (!enif_inspect_binary(env, head, &word_bin)) {
+            enif_free(symbols);
+            return enif_make_badarg(env);
+        }
+
+        int result = model_find_word(model_res->model, &word_bin);
+        if (result == -2) {
+            enif_free(symbols);
+            return make_error(env, "out_of_memory");
+        }
+        symbols[i] = enif_make_int(env, result);
+    }
+
+    ERL_NIF_TERM result = enif_make_list_from_array(env, symbols, count);
+    enif_free(symbols);
+    return result;
+}
+
+// Word list of a model as one binary (dirty IO NIF: reads the model
+// directory on first use). Read once per loaded model and shared by all its
+// handles; the returned binaries reference the native copy.
+static ERL_NIF_TERM vocabulary_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    ModelResource* model_res;
+
+    if (!enif_get_resource(env, argv[0], MODEL_TYPE, (void**)&model_res)) {
+        return enif_make_badarg(env);
+    }
+    ModelEntry* entry = model_res->entry;
+
+    enif_mutex_lock(model_registry.lock);
+    VocabularyResource* vocab = entry->vocabulary;
+    int missing = entry->vocabulary_missing;
+    if (vocab != NULL) {
+        enif_keep_resource(vocab);
+    }
+    enif_mutex_unlock(model_registry.lock);
+
+    if (vocab == NULL && !missing) {
+        // Read outside the registry lock; concurrent first calls may both
+        // read, and the first to finish is kept
+        size_t len = 0;
+        char* data = vosk_vocab_read(entry->path, &len);
+
+        if (data != NULL) {
+            vocab = enif_alloc_resource(VOCABULARY_TYPE, sizeof(VocabularyResource));
+            vocab->data = data;
+            vocab->len = len;
+        }
+
+        enif_mutex_lock(model_registry.lock);
+        if (entry->vocabulary != NULL) {
+            if (vocab != NULL) {
+                enif_release_resource(vocab);
+            }
+            vocab = entry->vocabulary;
+            enif_keep_resource(vocab);
+        } else if (vocab != NULL) {
+            // One reference for the entry, one for this call
+            entry->vocabulary = vocab;
+            enif_keep_resource(vocab);
+        } else {
+            entry->vocabulary_missing = 1;
+        }
+        enif_mutex_unlock(model_registry.lock);
+    }
+
+    if (vocab == NULL) {
+        return make_error(env, "vocabulary_unavailable");
+    }
+
+    ERL_NIF_TERM binary = enif_make_resource_binary(env, vocab, vocab->data, vocab->len);
+    enif_release_resource(vocab);
+    return enif_make_tuple2(env, enif_make_atom(env, "ok"), binary);
 }
 
-// Create recognizer
+// Create recognizer (dirty CPU NIF: large graphs take tens of milliseconds to set up)
 static ERL_NIF_TERM create_recognizer_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     ModelResource* model_res;
     double sample_rate;
@@ -116,8 +880,31 @@ static ERL_NIF_TERM create_recognizer_nif(ErlNifEnv* env, int argc, const ERL_NI
         return make_error(env, "recognizer_creation_failed");
     }
 
-    RecognizerResource* res = enif_alloc_resource(RECOGNIZER_TYPE, sizeof(RecognizerResource));
-    res->recognizer = rec;
+    return make_recognizer_resource(env, rec, (float)sample_rate);
+}
+
+// Load speaker model (dirty IO NIF: reads the x-vector extractor from disk)
+static ERL_NIF_TERM load_spk_model_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    ErlNifBinary path_bin;
+
+    if (!enif_inspect_binary(env, argv[0], &path_bin)) {
+        return enif_make_badarg(env);
+    }
+
+    char* path = alloc_cstring(&path_bin);
+    if (path == NULL) {
+        return make_error(env, "out_of_memory");
+    }
+
+    VoskSpkModel* model = vosk_spk_model_new(path);
+    enif_free(path);
+
+    if (model == NULL) {
+        return make_error(env, "spk_model_load_failed");
+    }
+
+    SpkModelResource* res = enif_alloc_resource(SPK_MODEL_TYPE, sizeof(SpkModelResource));
+    res->model = model;
 
     ERL_NIF_TERM term = enif_make_resource(env, res);
     enif_release_resource(res);
@@ -125,6 +912,101 @@ static ERL_NIF_TERM create_recognizer_nif(ErlNifEnv* env, int argc, const ERL_NI
     return enif_make_tuple2(env, enif_make_atom(env, "ok"), term);
 }
 
+// Create recognizer with speaker identification (dirty CPU NIF, as create_recognizer)
+static ERL_NIF_TERM create_recognizer_spk_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    ModelResource* model_res;
+    double sample_rate;
+    SpkModelResource* spk_res;
+
+    if (!enif_get_resource(env, argv[0], MODEL_TYPE, (void**)&model_res) ||
+        !enif_get_double(env, argv[1], &sample_rate) ||
+        !enif_get_resource(env, argv[2], SPK_MODEL_TYPE, (void**)&spk_res)) {
+        return enif_make_badarg(env);
+    }
+
+    VoskRecognizer* rec = vosk_recognizer_new_spk(model_res->model, (float)sample_rate, spk_res->model);
+    if (rec == NULL) {
+        return make_error(env, "recognizer_creation_failed");
+    }
+
+    return make_recognizer_resource(env, rec, (float)sample_rate);
+}
+
+// Attach a speaker model to an existing recognizer. libvosk only accepts it
+// before the first audio of an utterance has been fed.
+static ERL_NIF_TERM set_spk_model_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    SpkModelResource* spk_res;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_resource(env, argv[1], SPK_MODEL_TYPE, (void**)&spk_res)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    vosk_recognizer_set_spk_model(rec_res->recognizer, spk_res->model);
+    recognizer_release(rec_res);
+
+    return enif_make_atom(env, "ok");
+}
+
+// Create recognizer constrained to a grammar (dirty CPU NIF: compiles the phrase list)
+static ERL_NIF_TERM create_recognizer_grm_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    ModelResource* model_res;
+    double sample_rate;
+    ErlNifBinary grammar_bin;
+
+    if (!enif_get_resource(env, argv[0], MODEL_TYPE, (void**)&model_res) ||
+        !enif_get_double(env, argv[1], &sample_rate) ||
+        !enif_inspect_binary(env, argv[2], &grammar_bin)) {
+        return enif_make_badarg(env);
+    }
+
+    char* grammar = alloc_cstring(&grammar_bin);
+    if (grammar == NULL) {
+        return make_error(env, "out_of_memory");
+    }
+
+    VoskRecognizer* rec = vosk_recognizer_new_grm(model_res->model, (float)sample_rate, grammar);
+    enif_free(grammar);
+
+    if (rec == NULL) {
+        return make_error(env, "recognizer_creation_failed");
+    }
+
+    return make_recognizer_resource(env, rec, (float)sample_rate);
+}
+
+// Reconfigure recognizer grammar (dirty CPU NIF: rebuilds the grammar FST)
+static ERL_NIF_TERM set_grammar_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    ErlNifBinary grammar_bin;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_inspect_binary(env, argv[1], &grammar_bin)) {
+        return enif_make_badarg(env);
+    }
+
+    char* grammar = alloc_cstring(&grammar_bin);
+    if (grammar == NULL) {
+        return make_error(env, "out_of_memory");
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        enif_free(grammar);
+        return make_error(env, "busy");
+    }
+
+    vosk_recognizer_set_grm(rec_res->recognizer, grammar);
+    recognizer_release(rec_res);
+    enif_free(grammar);
+
+    return enif_make_atom(env, "ok");
+}
+
 // Set max alternatives
 static ERL_NIF_TERM set_max_alternatives_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     RecognizerResource* rec_res;
@@ -135,7 +1017,14 @@ static ERL_NIF_TERM set_max_alternatives_nif(ErlNifEnv* env, int argc, const ERL
         return enif_make_badarg(env);
     }
 
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
     vosk_recognizer_set_max_alternatives(rec_res->recognizer, max_alternatives);
+    rec_res->max_alternatives = max_alternatives;
+    recognizer_release(rec_res);
+
     return enif_make_atom(env, "ok");
 }
 
@@ -149,7 +1038,14 @@ static ERL_NIF_TERM set_words_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM a
         return enif_make_badarg(env);
     }
 
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
     vosk_recognizer_set_words(rec_res->recognizer, words);
+    rec_res->words = words;
+    recognizer_release(rec_res);
+
     return enif_make_atom(env, "ok");
 }
 
@@ -163,87 +1059,1708 @@ static ERL_NIF_TERM set_partial_words_nif(ErlNifEnv* env, int argc, const ERL_NI
         return enif_make_badarg(env);
     }
 
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
     vosk_recognizer_set_partial_words(rec_res->recognizer, partial_words);
+    rec_res->partial_words = partial_words;
+    recognizer_release(rec_res);
+
     return enif_make_atom(env, "ok");
 }
 
-// Accept waveform (dirty NIF for potentially long operation)
-static ERL_NIF_TERM accept_waveform_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+// Configure the input stage (dirty CPU NIF: designs the resampling filter).
+// argv: recognizer, input rate, channels. Input already at the recognizer's
+// rate in mono removes the stage.
+static ERL_NIF_TERM set_input_format_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     RecognizerResource* rec_res;
-    ErlNifBinary audio_data;
+    int input_rate;
+    int channels;
 
     if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
-        !enif_inspect_binary(env, argv[1], &audio_data)) {
+        !enif_get_int(env, argv[1], &input_rate) ||
+        !enif_get_int(env, argv[2], &channels)) {
         return enif_make_badarg(env);
     }
 
-    int result = vosk_recognizer_accept_waveform(
-        rec_res->recognizer,
-        (const char*)audio_data.data,
-        audio_data.size
-    );
+    int output_rate = (int)(rec_res->sample_rate + 0.5f);
+    VoskDsp* dsp = NULL;
+    if (input_rate != output_rate || channels != 1) {
+        dsp = vosk_dsp_create(input_rate, output_rate, channels);
+        if (dsp == NULL) {
+            return make_error(env, "invalid_input_format");
+        }
+    }
 
-    return enif_make_int(env, result);
+    if (!recognizer_acquire(rec_res)) {
+        vosk_dsp_destroy(dsp);
+        return make_error(env, "busy");
+    }
+
+    VoskDsp* old = rec_res->dsp;
+    rec_res->dsp = dsp;
+    recognizer_release(rec_res);
+    vosk_dsp_destroy(old);
+
+    return enif_make_atom(env, "ok");
+}
+
+// Enable the silence gate. argv: recognizer, threshold (dBFS), keep_ms,
+// preroll_ms. The gate's timeline must cover the recognizer's whole life, so
+// it can only be enabled once; Recognizer.new/3 does so before any audio.
+static ERL_NIF_TERM enable_vad_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    double threshold_db;
+    int keep_ms;
+    int preroll_ms;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_double(env, argv[1], &threshold_db) ||
+        !enif_get_int(env, argv[2], &keep_ms) ||
+        !enif_get_int(env, argv[3], &preroll_ms)) {
+        return enif_make_badarg(env);
+    }
+
+    VoskVad* vad = vosk_vad_create((int)(rec_res->sample_rate + 0.5f), threshold_db, keep_ms, preroll_ms);
+    if (vad == NULL) {
+        return make_error(env, "invalid_vad_options");
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        vosk_vad_destroy(vad);
+        return make_error(env, "busy");
+    }
+
+    if (rec_res->vad != NULL) {
+        recognizer_release(rec_res);
+        vosk_vad_destroy(vad);
+        return make_error(env, "already_enabled");
+    }
+    rec_res->vad = vad;
+    recognizer_release(rec_res);
+
+    return enif_make_atom(env, "ok");
+}
+
+// Silence gate counters: {:ok, %{decoded_frames: n, skipped_frames: n}}
+static ERL_NIF_TERM vad_stats_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    if (rec_res->vad == NULL) {
+        recognizer_release(rec_res);
+        return make_error(env, "vad_disabled");
+    }
+
+    uint64_t decoded, skipped;
+    vosk_vad_counters(rec_res->vad, &decoded, &skipped);
+    recognizer_release(rec_res);
+
+    ERL_NIF_TERM keys[2] = {
+        enif_make_atom(env, "decoded_frames"),
+        enif_make_atom(env, "skipped_frames")
+    };
+    ERL_NIF_TERM values[2] = {
+        enif_make_uint64(env, decoded),
+        enif_make_uint64(env, skipped)
+    };
+    ERL_NIF_TERM map;
+    enif_make_map_from_arrays(env, keys, values, 2, &map);
+
+    return enif_make_tuple2(env, enif_make_atom(env, "ok"), map);
+}
+
+// Configure the endpointer. argv: recognizer, threshold (dBFS), trailing
+// silence ms, max utterance ms; both durations 0 removes it. Unlike the
+// silence gate it can be changed at any time, e.g. per dialog turn; the
+// utterance in progress starts counting again.
+static ERL_NIF_TERM set_endpointer_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    double threshold_db;
+    int trailing_silence_ms;
+    int max_utterance_ms;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_double(env, argv[1], &threshold_db) ||
+        !enif_get_int(env, argv[2], &trailing_silence_ms) ||
+        !enif_get_int(env, argv[3], &max_utterance_ms)) {
+        return enif_make_badarg(env);
+    }
+
+    VoskEndpointer* ep = NULL;
+    if (trailing_silence_ms != 0 || max_utterance_ms != 0) {
+        ep = vosk_endpointer_create((int)(rec_res->sample_rate + 0.5f), threshold_db,
+                                    trailing_silence_ms, max_utterance_ms);
+        if (ep == NULL) {
+            return make_error(env, "invalid_endpointer_options");
+        }
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        vosk_endpointer_destroy(ep);
+        return make_error(env, "busy");
+    }
+
+    VoskEndpointer* old = rec_res->endpointer;
+    rec_res->endpointer = ep;
+    recognizer_release(rec_res);
+    vosk_endpointer_destroy(old);
+
+    return enif_make_atom(env, "ok");
+}
+
+// Per-frame RMS levels of s16le mono audio (dirty CPU NIF).
+// argv: audio binary, sample rate. Returns a binary of native-endian 32-bit
+// floats, one dBFS value per 10 ms frame.
+static ERL_NIF_TERM audio_levels_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    ErlNifBinary audio;
+    int sample_rate;
+
+    if (!enif_inspect_binary(env, argv[0], &audio) ||
+        !enif_get_int(env, argv[1], &sample_rate) ||
+        sample_rate < 1000) {
+        return enif_make_badarg(env);
+    }
+
+    size_t frame_bytes = (size_t)sample_rate / 100 * 2;
+    size_t frames = audio.size / frame_bytes;
+    ERL_NIF_TERM term;
+    float* levels = (float*)enif_make_new_binary(env, frames * sizeof(float), &term);
+    vosk_vad_levels_s16(audio.data, audio.size, sample_rate, levels);
+    return term;
+}
+
+// Bytes fed to libvosk per dirty NIF invocation (about 2 s of 16 kHz s16le)
+// when splitting is requested. Longer inputs are split and the NIF
+// reschedules itself between slices, so one long file does not occupy a
+// dirty scheduler for its whole duration. Without splitting the input is fed
+// in one libvosk call, as libvosk only checks for an endpoint at the end of a
+// call: a slice boundary could otherwise end an utterance mid-input.
+// A multiple of every sample size, so slices never split a sample.
+#define ACCEPT_SLICE_BYTES 65536
+
+// Start a new tail at the current position (caller holds the lock)
+static void tail_clear(RecognizerResource* res) {
+    res->tail_len = 0;
+    res->tail_overflow = 0;
+    res->tail_start = res->position;
+}
+
+// Advance the position by `count` mono samples at the recognizer's rate and
+// keep them in the tail when checkpoints are enabled. Samples are given as
+// floats in the 16-bit range or, when `floats` is NULL, as s16le bytes.
+static void tail_append(RecognizerResource* res, const float* floats, const unsigned char* s16,
+                        size_t count) {
+    res->position += count;
+    if (res->tail_max == 0 || res->tail_overflow) {
+        return;
+    }
+
+    size_t bytes = count * 2;
+    if (res->tail_len + bytes > res->tail_max) {
+        // A checkpoint could not restore this utterance anyway; free the memory
+        if (res->tail != NULL) {
+            enif_free(res->tail);
+            res->tail = NULL;
+        }
+        res->tail_cap = 0;
+        res->tail_len = 0;
+        res->tail_overflow = 1;
+        return;
+    }
+    if (res->tail_len + bytes > res->tail_cap) {
+        size_t cap = res->tail_cap > 0 ? res->tail_cap * 2 : 65536;
+        while (cap < res->tail_len + bytes) {
+            cap *= 2;
+        }
+        if (cap > res->tail_max) {
+            cap = res->tail_max;
+        }
+        unsigned char* tail = enif_realloc(res->tail, cap);
+        if (tail == NULL) {
+            res->tail_overflow = 1;
+            return;
+        }
+        res->tail = tail;
+        res->tail_cap = cap;
+    }
+
+    unsigned char* out = res->tail + res->tail_len;
+    if (floats == NULL) {
+        memcpy(out, s16, bytes);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            float x = floats[i];
+            int v = x >= 32767.0f ? 32767 : x <= -32768.0f ? -32768
+                  : (int)(x + (x >= 0.0f ? 0.5f : -0.5f));
+            out[2 * i] = (unsigned char)(v & 0xff);
+            out[2 * i + 1] = (unsigned char)((v >> 8) & 0xff);
+        }
+    }
+    res->tail_len += bytes;
+}
+
+// Keep samples about to be decoded in the tail and run the endpointer on
+// them; returns 1 if the endpointer ends the utterance
+static int observe_samples(RecognizerResource* res, const float* floats, const unsigned char* s16,
+                           size_t count) {
+    tail_append(res, floats, s16, count);
+    return res->endpointer != NULL && vosk_endpointer_process(res->endpointer, floats, s16, count);
+}
+
+// Combine libvosk's status with the endpointer's verdict
+static int endpoint_status(RecognizerResource* res, int result, int forced) {
+    if (result == 1 && res->endpointer != NULL) {
+        vosk_endpointer_reset(res->endpointer);
+    } else if (result == 0 && forced) {
+        res->ep_forced = 1;
+        return 1;
+    }
+    return result;
+}
+
+// Feed `len` bytes of samples in `format` to libvosk, through the input stage
+// when one is configured. s16le goes to the typed short entry point when the
+// data is aligned for it. f32le samples are normalized to [-1.0, 1.0] (as
+// media pipelines produce them) while libvosk expects the 16-bit range, so
+// they are scaled into a float buffer in one pass. *samples is set to the
+// mono samples fed at the recognizer's rate, before the silence gate.
+static int decode_samples(RecognizerResource* res, const unsigned char* data, size_t len,
+                          int format, ErlNifUInt64* samples) {
+    VoskRecognizer* rec = res->recognizer;
+
+    if (res->vad != NULL && res->dsp == NULL) {
+        int rate = (int)(res->sample_rate + 0.5f);
+        res->dsp = vosk_dsp_create(rate, rate, 1);
+        if (res->dsp == NULL) {
+            return -1;
+        }
+    }
+
+    if (res->dsp != NULL) {
+        const float* mono;
+        int count = vosk_dsp_process(res->dsp, data, len, format, &mono);
+        *samples = count > 0 ? (ErlNifUInt64)count : 0;
+        int forced = count > 0 && observe_samples(res, mono, NULL, (size_t)count);
+        if (count >= 0 && res->vad != NULL) {
+            count = vosk_vad_process(res->vad, mono, (size_t)count, &mono);
+        }
+        return count < 0 ? -1
+             : endpoint_status(res, vosk_recognizer_accept_waveform_f(rec, mono, count), forced);
+    }
+
+    if (format == SAMPLE_FORMAT_F32LE) {
+        size_t count = len / sizeof(float);
+        *samples = count;
+        float* scaled = enif_alloc(count * sizeof(float) + 1);
+        if (scaled == NULL) {
+            return -1;
+        }
+        memcpy(scaled, data, count * sizeof(float));
+        for (size_t i = 0; i < count; i++) {
+            scaled[i] *= 32768.0f;
+        }
+        int forced = observe_samples(res, scaled, NULL, count);
+        int result = vosk_recognizer_accept_waveform_f(rec, scaled, (int)count);
+        enif_free(scaled);
+        return endpoint_status(res, result, forced);
+    }
+
+    *samples = len / sizeof(short);
+    int forced = observe_samples(res, NULL, data, len / sizeof(short));
+    int result;
+    if (((size_t)data & (sizeof(short) - 1)) == 0) {
+        result = vosk_recognizer_accept_waveform_s(rec, (const short*)data, (int)(len / sizeof(short)));
+    } else {
+        result = vosk_recognizer_accept_waveform(rec, (const char*)data, (int)len);
+    }
+    return endpoint_status(res, result, forced);
+}
+
+// Add native time since `started` and the work done to the current call, the
+// recognizer's counters and the node totals. `delta` has everything but the time.
+static void count_call(RecognizerResource* res, ErlNifTime started, VoskCounters* delta) {
+    delta->native_ns = (ErlNifUInt64)(enif_monotonic_time(ERL_NIF_NSEC) - started);
+
+    enif_mutex_lock(res->stats_lock);
+    res->call_ns += delta->native_ns;
+    res->call_samples += delta->samples;
+    counters_add(&res->counters, delta);
+    enif_mutex_unlock(res->stats_lock);
+
+    enif_mutex_lock(recognizer_stats.lock);
+    counters_add(&recognizer_stats.totals, delta);
+    recognizer_stats.audio_seconds += (double)delta->samples / res->sample_rate;
+    enif_mutex_unlock(recognizer_stats.lock);
+}
+
+// decode_samples, timed for last_call_stats
+static int feed_samples(RecognizerResource* res, const unsigned char* data, size_t len, int format) {
+    ErlNifTime started = enif_monotonic_time(ERL_NIF_NSEC);
+    VoskCounters delta = {0};
+    int result = decode_samples(res, data, len, format, &delta.samples);
+    count_call(res, started, &delta);
+    return result;
+}
+
+static ERL_NIF_TERM accept_waveform_continue_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]);
+
+// Feed one slice of `audio` starting at `offset` (caller holds the lock and
+// this releases it), or all of it when `split` is 0. Returns the final
+// status, {1, rest} when an utterance ends before the input does, or
+// claims the recognizer and reschedules itself for the next slice.
+static ERL_NIF_TERM accept_waveform_slice(ErlNifEnv* env, RecognizerResource* rec_res,
+                                          const ERL_NIF_TERM argv[], ERL_NIF_TERM audio_term,
+                                          const ErlNifBinary* audio, size_t offset, int format,
+                                          int split) {
+    // Slices end on a frame boundary so the input stage never sees a split frame
+    size_t frame = rec_res->dsp != NULL ? vosk_dsp_frame_bytes(rec_res->dsp, format) : 1;
+    size_t len = audio->size - offset;
+    if (split && len > ACCEPT_SLICE_BYTES) {
+        len = ACCEPT_SLICE_BYTES - ACCEPT_SLICE_BYTES % frame;
+    }
+
+    int result = feed_samples(rec_res, audio->data + offset, len, format);
+    offset += len;
+
+    if (offset < audio->size && result == 0) {
+        if (rec_res->claimed || recognizer_claim(env, rec_res)) {
+            recognizer_release(rec_res);
+            ERL_NIF_TERM next_argv[4] = {argv[0], audio_term, argv[2], enif_make_uint64(env, offset)};
+            return enif_schedule_nif(env, "accept_waveform", ERL_NIF_DIRTY_JOB_CPU_BOUND,
+                                     accept_waveform_continue_nif, 4, next_argv);
+        }
+        // The recognizer cannot be kept across a reschedule; finish here
+        result = feed_samples(rec_res, audio->data + offset, audio->size - offset, format);
+        offset = audio->size;
+    }
+
+    if (rec_res->claimed) {
+        recognizer_unclaim(env, rec_res);
+    }
+    recognizer_release(rec_res);
+
+    if (result == 1 && offset < audio->size) {
+        // Feeding on would discard this utterance's result; hand the rest back
+        ERL_NIF_TERM rest = enif_make_sub_binary(env, audio_term, offset, audio->size - offset);
+        return enif_make_tuple2(env, enif_make_int(env, 1), rest);
+    }
+    return enif_make_int(env, result);
+}
+
+// Accept waveform (dirty NIF for potentially long operation). Takes a binary
+// or an iolist; iolists are flattened natively instead of in Elixir.
+// argv: recognizer, audio, sample format, split (1 to decode in slices).
+static ERL_NIF_TERM accept_waveform_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    ErlNifBinary audio_data;
+    ERL_NIF_TERM audio_term = argv[1];
+    int format;
+    int split;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_int(env, argv[2], &format) ||
+        !enif_get_int(env, argv[3], &split) ||
+        (format != SAMPLE_FORMAT_S16LE && format != SAMPLE_FORMAT_F32LE)) {
+        return enif_make_badarg(env);
+    }
+    if (!enif_inspect_binary(env, audio_term, &audio_data)) {
+        if (!enif_inspect_iolist_as_binary(env, audio_term, &audio_data)) {
+            return enif_make_badarg(env);
+        }
+        // The flattened iolist only lives for this call; keep a binary term
+        // of it when the input has to be carried across reschedules
+        if (split && audio_data.size > ACCEPT_SLICE_BYTES) {
+            unsigned char* copy = enif_make_new_binary(env, audio_data.size, &audio_term);
+            memcpy(copy, audio_data.data, audio_data.size);
+            enif_inspect_binary(env, audio_term, &audio_data);
+        }
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    return accept_waveform_slice(env, rec_res, argv, audio_term, &audio_data, 0, format, split);
+}
+
+// Continuation of accept_waveform for inputs split into more than one slice.
+// argv: recognizer, audio binary, sample format, byte offset.
+static ERL_NIF_TERM accept_waveform_continue_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    ErlNifBinary audio_data;
+    int format;
+    ErlNifUInt64 offset;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_inspect_binary(env, argv[1], &audio_data) ||
+        !enif_get_int(env, argv[2], &format) ||
+        !enif_get_uint64(env, argv[3], &offset)) {
+        return enif_make_badarg(env);
+    }
+
+    // The recognizer is still claimed for this call, so the lock is only
+    // held briefly by calls that find it claimed; retry rather than block a
+    // dirty scheduler. The call timing carries on from the earlier slices.
+    if (enif_mutex_trylock(rec_res->lock) != 0) {
+        return enif_schedule_nif(env, "accept_waveform", ERL_NIF_DIRTY_JOB_CPU_BOUND,
+                                 accept_waveform_continue_nif, argc, argv);
+    }
+
+    return accept_waveform_slice(env, rec_res, argv, argv[1], &audio_data, (size_t)offset, format, 1);
+}
+
+// Which libvosk result getter fetch_result calls
+#define RESULT_UTTERANCE 0
+#define RESULT_PARTIAL 1
+#define RESULT_FINAL 2
+
+// Drop the remembered partial, so the next "if changed" fetch always returns
+static void forget_partial(RecognizerResource* res) {
+    if (res->last_partial != NULL) {
+        enif_free(res->last_partial);
+        res->last_partial = NULL;
+    }
+}
+
+// Compare a partial result with the last one handed out and remember it.
+// Returns 0 if it is unchanged. Caller holds the recognizer lock.
+static int partial_changed(RecognizerResource* res, const char* json) {
+    if (json == NULL) {
+        return 1;
+    }
+    if (res->last_partial != NULL && strcmp(res->last_partial, json) == 0) {
+        return 0;
+    }
+
+    forget_partial(res);
+    size_t len = strlen(json);
+    res->last_partial = enif_alloc(len + 1);
+    if (res->last_partial != NULL) {
+        memcpy(res->last_partial, json, len + 1);
+    }
+    return 1;
+}
+
+// Fetch a result JSON string (caller holds the lock). With a silence gate,
+// buffered audio is flushed before a final result and word times are mapped
+// back to the input timeline, and a restored recognizer shifts them onto the
+// original one's; *owned is then set to the rewritten string, which the
+// caller frees with enif_free after building its term.
+static const char* fetch_result(RecognizerResource* res, int kind, char** owned) {
+    ErlNifTime started = enif_monotonic_time(ERL_NIF_NSEC);
+    *owned = NULL;
+
+    int forced = kind == RESULT_UTTERANCE && res->ep_forced;
+    if (kind != RESULT_PARTIAL) {
+        forget_partial(res);
+        tail_clear(res);
+        res->ep_forced = 0;
+        if (res->endpointer != NULL) {
+            vosk_endpointer_reset(res->endpointer);
+        }
+    }
+
+    if (kind == RESULT_FINAL && res->vad != NULL) {
+        const float* rest;
+        int count = vosk_vad_flush(res->vad, &rest);
+        if (count > 0) {
+            vosk_recognizer_accept_waveform_f(res->recognizer, rest, count);
+        }
+    }
+
+    const char* json = kind == RESULT_UTTERANCE && !forced ? vosk_recognizer_result(res->recognizer)
+                     : kind == RESULT_PARTIAL ? vosk_recognizer_partial_result(res->recognizer)
+                     : vosk_recognizer_final_result(res->recognizer);
+
+    if (res->vad != NULL || res->time_shift != 0) {
+        double offset = (double)res->time_shift / res->sample_rate;
+        *owned = vosk_vad_remap_json(res->vad, offset, json);
+        if (*owned != NULL) {
+            json = *owned;
+        }
+    }
+    VoskCounters delta = {0};
+    delta.utterances = kind != RESULT_PARTIAL;
+    delta.result_bytes = json != NULL ? strlen(json) : 0;
+    count_call(res, started, &delta);
+    return json;
+}
+
+// Feed audio and fetch the matching result in one call (dirty CPU NIF).
+// argv: recognizer, audio (binary or iolist), want_partial (0 = no, 1 = yes,
+// 2 = only when it changed), decode (0 = JSON, 1 = native, 2 = native with
+// packed word timings), sample format. The input is fed in one libvosk call,
+// like accept_waveform without splitting, so it yields at most one result.
+// Returns {:utterance, result}, {:partial, result}, :unchanged, :continue or
+// :error, where result is a decoded map when decode is set and JSON otherwise.
+static ERL_NIF_TERM feed_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    ErlNifBinary audio_data;
+    int want_partial;
+    int decode;
+    int format;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !(enif_inspect_binary(env, argv[1], &audio_data) ||
+          enif_inspect_iolist_as_binary(env, argv[1], &audio_data)) ||
+        !enif_get_int(env, argv[2], &want_partial) ||
+        !enif_get_int(env, argv[3], &decode) ||
+        !enif_get_int(env, argv[4], &format) ||
+        (format != SAMPLE_FORMAT_S16LE && format != SAMPLE_FORMAT_F32LE)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    int ended = feed_samples(rec_res, audio_data.data, audio_data.size, format);
+
+    ERL_NIF_TERM reply;
+    if (ended < 0) {
+        reply = enif_make_atom(env, "error");
+    } else if (ended == 0 && !want_partial) {
+        reply = enif_make_atom(env, "continue");
+    } else {
+        char* owned;
+        const char* json = fetch_result(rec_res, ended == 1 ? RESULT_UTTERANCE : RESULT_PARTIAL, &owned);
+        if (ended == 0 && want_partial == 2 && !partial_changed(rec_res, json)) {
+            reply = enif_make_atom(env, "unchanged");
+        } else {
+            ERL_NIF_TERM result;
+            int flags = decode == 2 ? VOSK_JSON_PACK_WORDS : 0;
+            if (!decode || json == NULL || !vosk_json_decode(env, json, strlen(json), flags, &result)) {
+                result = make_json_binary(env, json);
+            }
+            reply = enif_make_tuple2(env, enif_make_atom(env, ended == 1 ? "utterance" : "partial"), result);
+        }
+        if (owned != NULL) {
+            enif_free(owned);
+        }
+    }
+    recognizer_release(rec_res);
+
+    return reply;
+}
+
+// Get result
+static ERL_NIF_TERM get_result_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    char* owned;
+    const char* result = fetch_result(rec_res, RESULT_UTTERANCE, &owned);
+    ERL_NIF_TERM term = make_json_binary(env, result);
+    if (owned != NULL) {
+        enif_free(owned);
+    }
+    recognizer_release(rec_res);
+
+    return term;
+}
+
+// Get partial result
+static ERL_NIF_TERM get_partial_result_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    char* owned;
+    const char* result = fetch_result(rec_res, RESULT_PARTIAL, &owned);
+    ERL_NIF_TERM term = make_json_binary(env, result);
+    if (owned != NULL) {
+        enif_free(owned);
+    }
+    recognizer_release(rec_res);
+
+    return term;
+}
+
+// Get final result
+static ERL_NIF_TERM get_final_result_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    char* owned;
+    const char* result = fetch_result(rec_res, RESULT_FINAL, &owned);
+    ERL_NIF_TERM term = make_json_binary(env, result);
+    if (owned != NULL) {
+        enif_free(owned);
+    }
+    recognizer_release(rec_res);
+
+    return term;
+}
+
+// Helper function to decode a libvosk JSON result into Erlang terms
+static ERL_NIF_TERM make_decoded_result(ErlNifEnv* env, const char* json, int flags) {
+    ERL_NIF_TERM term;
+    if (json == NULL || !vosk_json_decode(env, json, strlen(json), flags, &term)) {
+        return make_error(env, "invalid_json");
+    }
+    return enif_make_tuple2(env, enif_make_atom(env, "ok"), term);
+}
+
+// Get result decoded natively into maps and lists (pack_words: 0/1)
+static ERL_NIF_TERM get_result_decoded_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    int pack_words;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_int(env, argv[1], &pack_words)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    char* owned;
+    const char* result = fetch_result(rec_res, RESULT_UTTERANCE, &owned);
+    ERL_NIF_TERM term = make_decoded_result(env, result, pack_words ? VOSK_JSON_PACK_WORDS : 0);
+    if (owned != NULL) {
+        enif_free(owned);
+    }
+    recognizer_release(rec_res);
+
+    return term;
+}
+
+// Get partial result decoded natively into maps and lists (pack_words: 0/1)
+static ERL_NIF_TERM get_partial_result_decoded_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    int pack_words;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_int(env, argv[1], &pack_words)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    char* owned;
+    const char* result = fetch_result(rec_res, RESULT_PARTIAL, &owned);
+    ERL_NIF_TERM term = make_decoded_result(env, result, pack_words ? VOSK_JSON_PACK_WORDS : 0);
+    if (owned != NULL) {
+        enif_free(owned);
+    }
+    recognizer_release(rec_res);
+
+    return term;
+}
+
+// Get final result decoded natively into maps and lists (pack_words: 0/1)
+static ERL_NIF_TERM get_final_result_decoded_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    int pack_words;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_int(env, argv[1], &pack_words)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    char* owned;
+    const char* result = fetch_result(rec_res, RESULT_FINAL, &owned);
+    ERL_NIF_TERM term = make_decoded_result(env, result, pack_words ? VOSK_JSON_PACK_WORDS : 0);
+    if (owned != NULL) {
+        enif_free(owned);
+    }
+    recognizer_release(rec_res);
+
+    return term;
+}
+
+// Get the partial result only if it differs from the one this NIF (or feed
+// with want_partial 2) last returned. argv: recognizer, decode as in feed.
+// Returns :unchanged, {:ok, json} or {:ok, map}.
+static ERL_NIF_TERM partial_result_if_changed_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    int decode;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_int(env, argv[1], &decode)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    char* owned;
+    const char* result = fetch_result(rec_res, RESULT_PARTIAL, &owned);
+    ERL_NIF_TERM term;
+    if (!partial_changed(rec_res, result)) {
+        term = enif_make_atom(env, "unchanged");
+    } else if (decode) {
+        term = make_decoded_result(env, result, decode == 2 ? VOSK_JSON_PACK_WORDS : 0);
+    } else {
+        term = enif_make_tuple2(env, enif_make_atom(env, "ok"), make_json_binary(env, result));
+    }
+    if (owned != NULL) {
+        enif_free(owned);
+    }
+    recognizer_release(rec_res);
+
+    return term;
+}
+
+// Native timing of the last call that claimed the recognizer:
+// {native_ns, audio_ns}, where audio_ns is the duration of the audio it fed.
+// Never waits for a running call.
+static ERL_NIF_TERM last_call_stats_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+        return enif_make_badarg(env);
+    }
+
+    enif_mutex_lock(rec_res->stats_lock);
+    ErlNifUInt64 native_ns = rec_res->call_ns;
+    ErlNifUInt64 samples = rec_res->call_samples;
+    enif_mutex_unlock(rec_res->stats_lock);
+
+    ErlNifUInt64 audio_ns = (ErlNifUInt64)((double)samples * 1e9 / rec_res->sample_rate);
+    return enif_make_tuple2(env, enif_make_uint64(env, native_ns), enif_make_uint64(env, audio_ns));
+}
+
+// Helper function to build a map of counters
+static ERL_NIF_TERM make_counters_map(ErlNifEnv* env, const VoskCounters* counters) {
+    ERL_NIF_TERM keys[4] = {
+        enif_make_atom(env, "samples_fed"),
+        enif_make_atom(env, "decode_ns"),
+        enif_make_atom(env, "utterances"),
+        enif_make_atom(env, "result_bytes")
+    };
+    ERL_NIF_TERM values[4] = {
+        enif_make_uint64(env, counters->samples),
+        enif_make_uint64(env, counters->native_ns),
+        enif_make_uint64(env, counters->utterances),
+        enif_make_uint64(env, counters->result_bytes)
+    };
+    ERL_NIF_TERM map;
+    enif_make_map_from_arrays(env, keys, values, 4, &map);
+    return map;
+}
+
+// Cumulative counters of one recognizer. Never waits for a running call.
+static ERL_NIF_TERM recognizer_stats_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+        return enif_make_badarg(env);
+    }
+
+    enif_mutex_lock(rec_res->stats_lock);
+    VoskCounters counters = rec_res->counters;
+    enif_mutex_unlock(rec_res->stats_lock);
+
+    ERL_NIF_TERM map = make_counters_map(env, &counters);
+    double audio_seconds = (double)counters.samples / rec_res->sample_rate;
+    enif_make_map_put(env, map, enif_make_atom(env, "audio_seconds"),
+                      enif_make_double(env, audio_seconds), &map);
+    return map;
+}
+
+// How the NIF was built: the CPU clones of the audio kernels, the one in use
+// here, whether link-time optimization was on and which libvosk it links.
+// Set by the Makefile's VOSK_* options.
+static ERL_NIF_TERM build_info_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    static const char* const targets[] = VOSK_DISPATCH_TARGETS;
+    size_t count = sizeof(targets) / sizeof(targets[0]);
+    ERL_NIF_TERM variants[sizeof(targets) / sizeof(targets[0])];
+    for (size_t i = 0; i < count; i++) {
+        variants[i] = enif_make_atom(env, targets[i]);
+    }
+    ERL_NIF_TERM list = enif_make_list_from_array(env, variants, (unsigned)count);
+
+#ifdef VOSK_LTO
+    const char* lto = "true";
+#else
+    const char* lto = "false";
+#endif
+#ifdef VOSK_LOCAL_LIB
+    const char* libvosk = "local";
+#else
+    const char* libvosk = "bundled";
+#endif
+
+    ERL_NIF_TERM keys[4] = {
+        enif_make_atom(env, "cpu_variants"),
+        enif_make_atom(env, "cpu_variant"),
+        enif_make_atom(env, "lto"),
+        enif_make_atom(env, "libvosk")
+    };
+    ERL_NIF_TERM values[4] = {
+        list,
+        enif_make_atom(env, vosk_cpu_variant()),
+        enif_make_atom(env, lto),
+        enif_make_atom(env, libvosk)
+    };
+    ERL_NIF_TERM map;
+    enif_make_map_from_arrays(env, keys, values, 4, &map);
+    return map;
+}
+
+// Node-wide counters: the recognizer totals, plus live and lifetime
+// recognizer counts and the number of loaded models (distinct paths)
+static ERL_NIF_TERM native_stats_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    enif_mutex_lock(recognizer_stats.lock);
+    VoskCounters totals = recognizer_stats.totals;
+    double audio_seconds = recognizer_stats.audio_seconds;
+    ErlNifUInt64 created = recognizer_stats.created;
+    ErlNifUInt64 destroyed = recognizer_stats.destroyed;
+    enif_mutex_unlock(recognizer_stats.lock);
+
+    unsigned models = 0;
+    enif_mutex_lock(model_registry.lock);
+    for (ModelEntry* entry = model_registry.entries; entry != NULL; entry = entry->next) {
+        models += !entry->loading;
+    }
+    enif_mutex_unlock(model_registry.lock);
+
+    ERL_NIF_TERM map = make_counters_map(env, &totals);
+    enif_make_map_put(env, map, enif_make_atom(env, "audio_seconds"),
+                      enif_make_double(env, audio_seconds), &map);
+    enif_make_map_put(env, map, enif_make_atom(env, "recognizers"),
+                      enif_make_uint64(env, created - destroyed), &map);
+    enif_make_map_put(env, map, enif_make_atom(env, "recognizers_created"),
+                      enif_make_uint64(env, created), &map);
+    enif_make_map_put(env, map, enif_make_atom(env, "models"),
+                      enif_make_uint(env, models), &map);
+    return map;
+}
+
+// Reset recognizer (dirty CPU NIF: tears down and rebuilds decoder state)
+static ERL_NIF_TERM reset_recognizer_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+        return enif_make_badarg(env);
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    vosk_recognizer_reset(rec_res->recognizer);
+    if (rec_res->dsp != NULL) {
+        vosk_dsp_reset(rec_res->dsp);
+    }
+    if (rec_res->vad != NULL) {
+        vosk_vad_reset(rec_res->vad);
+    }
+    forget_partial(rec_res);
+    tail_clear(rec_res);
+    // A restored timeline ends here. libvosk keeps counting samples across
+    // a reset, as `position` does, so later times match a recognizer that
+    // was never restored and the next checkpoint starts at `position`.
+    rec_res->time_shift = 0;
+    rec_res->ep_forced = 0;
+    if (rec_res->endpointer != NULL) {
+        vosk_endpointer_reset(rec_res->endpointer);
+    }
+    recognizer_release(rec_res);
+
+    return enif_make_atom(env, "ok");
 }
 
-// Get result
-static ERL_NIF_TERM get_result_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+// Keep the audio of the utterance in progress for checkpoints.
+// argv: recognizer, maximum tail in bytes (0 disables).
+static ERL_NIF_TERM enable_checkpoints_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     RecognizerResource* rec_res;
+    ErlNifUInt64 max_bytes;
 
-    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_uint64(env, argv[1], &max_bytes)) {
         return enif_make_badarg(env);
     }
 
-    const char* result = vosk_recognizer_result(rec_res->recognizer);
-    return enif_make_string(env, result, ERL_NIF_UTF8);
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    rec_res->tail_max = (size_t)max_bytes & ~(size_t)1;
+    if (rec_res->tail != NULL) {
+        enif_free(rec_res->tail);
+        rec_res->tail = NULL;
+    }
+    rec_res->tail_cap = 0;
+    // Audio fed before this point is missing from the tail
+    rec_res->tail_len = 0;
+    rec_res->tail_overflow = rec_res->position != rec_res->tail_start;
+    recognizer_release(rec_res);
+
+    return enif_make_atom(env, "ok");
 }
 
-// Get partial result
-static ERL_NIF_TERM get_partial_result_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+// Snapshot of the utterance in progress: {:ok, %{sample_rate, start, words,
+// partial_words, max_alternatives, audio}}, where `audio` is the tail and
+// `start` its position in samples on the original recognizer's timeline
+static ERL_NIF_TERM checkpoint_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     RecognizerResource* rec_res;
 
     if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
         return enif_make_badarg(env);
     }
 
-    const char* result = vosk_recognizer_partial_result(rec_res->recognizer);
-    return enif_make_string(env, result, ERL_NIF_UTF8);
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    if (rec_res->tail_max == 0 || rec_res->tail_overflow) {
+        const char* reason = rec_res->tail_max == 0 ? "checkpoints_disabled" : "tail_overflow";
+        recognizer_release(rec_res);
+        return make_error(env, reason);
+    }
+
+    ERL_NIF_TERM audio;
+    unsigned char* data = enif_make_new_binary(env, rec_res->tail_len, &audio);
+    if (rec_res->tail_len > 0) {
+        memcpy(data, rec_res->tail, rec_res->tail_len);
+    }
+
+    ERL_NIF_TERM keys[6] = {
+        enif_make_atom(env, "sample_rate"),
+        enif_make_atom(env, "start"),
+        enif_make_atom(env, "words"),
+        enif_make_atom(env, "partial_words"),
+        enif_make_atom(env, "max_alternatives"),
+        enif_make_atom(env, "audio")
+    };
+    ERL_NIF_TERM values[6] = {
+        enif_make_double(env, rec_res->sample_rate),
+        enif_make_int64(env, (ErlNifSInt64)rec_res->tail_start + rec_res->time_shift),
+        enif_make_int(env, rec_res->words),
+        enif_make_int(env, rec_res->partial_words),
+        enif_make_int(env, rec_res->max_alternatives),
+        audio
+    };
+    recognizer_release(rec_res);
+
+    ERL_NIF_TERM map;
+    enif_make_map_from_arrays(env, keys, values, 6, &map);
+
+    return enif_make_tuple2(env, enif_make_atom(env, "ok"), map);
 }
 
-// Get final result
-static ERL_NIF_TERM get_final_result_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+// Replay a checkpoint's tail into a recognizer with no utterance in progress
+// (dirty CPU NIF). argv: recognizer, checkpoint sample rate, s16le tail,
+// start. The tail goes through the silence gate but not the input stage,
+// since it is already at the recognizer's rate. Returns the status of
+// accept_waveform; the original recognizer had not ended the utterance, so
+// libvosk normally goes on, but a result can be fetched if it does not.
+static ERL_NIF_TERM restore_checkpoint_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     RecognizerResource* rec_res;
+    double sample_rate;
+    ErlNifBinary audio;
+    ErlNifSInt64 start;
 
-    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_double(env, argv[1], &sample_rate) ||
+        !enif_inspect_binary(env, argv[2], &audio) ||
+        !enif_get_int64(env, argv[3], &start) ||
+        audio.size % 2 != 0 || start < 0) {
         return enif_make_badarg(env);
     }
+    if ((float)sample_rate != rec_res->sample_rate) {
+        return make_error(env, "sample_rate_mismatch");
+    }
+
+    size_t count = audio.size / 2;
+    float* samples = enif_alloc(count * sizeof(float) + 1);
+    if (samples == NULL) {
+        return make_error(env, "out_of_memory");
+    }
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = (float)(int16_t)(audio.data[2 * i] | (audio.data[2 * i + 1] << 8));
+    }
+
+    if (!recognizer_acquire(rec_res)) {
+        enif_free(samples);
+        return make_error(env, "busy");
+    }
+    if (rec_res->position != rec_res->tail_start) {
+        recognizer_release(rec_res);
+        enif_free(samples);
+        return make_error(env, "not_idle");
+    }
+
+    ErlNifTime started = enif_monotonic_time(ERL_NIF_NSEC);
+    rec_res->time_shift = start - (ErlNifSInt64)rec_res->position;
+    int forced = observe_samples(rec_res, samples, NULL, count);
 
-    const char* result = vosk_recognizer_final_result(rec_res->recognizer);
-    return enif_make_string(env, result, ERL_NIF_UTF8);
+    const float* fed = samples;
+    int fed_count = (int)count;
+    if (rec_res->vad != NULL) {
+        fed_count = vosk_vad_process(rec_res->vad, samples, count, &fed);
+    }
+    int result = -1;
+    if (fed_count >= 0) {
+        result = vosk_recognizer_accept_waveform_f(rec_res->recognizer, fed, fed_count);
+        result = endpoint_status(rec_res, result, forced);
+    }
+
+    VoskCounters delta = {0};
+    delta.samples = count;
+    count_call(rec_res, started, &delta);
+    recognizer_release(rec_res);
+    enif_free(samples);
+
+    return enif_make_int(env, result);
 }
 
-// Reset recognizer
-static ERL_NIF_TERM reset_recognizer_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+// Send {:vosk_batch, tag, payload} to a batch recognizer's owner.
+// Called from the batch worker thread with the engine lock held.
+static void batch_send(BatchEngine* engine, BatchRecognizerResource* rec, ERL_NIF_TERM payload) {
+    ErlNifEnv* env = engine->msg_env;
+    ERL_NIF_TERM msg = enif_make_tuple3(env,
+        enif_make_atom(env, "vosk_batch"),
+        enif_make_copy(env, rec->tag),
+        payload);
+    enif_send(NULL, &rec->owner, env, msg);
+    enif_clear_env(env);
+}
+
+// Batch worker thread: drains finished results from every recognizer of the
+// model and pushes them to their owners, waiting on the GPU while chunks are
+// still pending and sleeping on the condition variable when idle.
+static void* batch_worker(void* arg) {
+    BatchEngine* engine = (BatchEngine*)arg;
+    vosk_gpu_thread_init();
+
+    enif_mutex_lock(engine->lock);
+    while (engine->running) {
+        int pending = 0;
+        engine->has_work = 0;
+
+        for (BatchRecognizerResource* rec = engine->recognizers; rec != NULL; rec = rec->next) {
+            const char* json;
+            while ((json = vosk_batch_recognizer_front_result(rec->recognizer)) != NULL &&
+                   json[0] != '\0') {
+                ErlNifEnv* env = engine->msg_env;
+                ERL_NIF_TERM result;
+                if (!vosk_json_decode(env, json, strlen(json), 0, &result)) {
+                    result = make_json_binary(env, json);
+                }
+                batch_send(engine, rec, enif_make_tuple2(env, enif_make_atom(env, "result"), result));
+                vosk_batch_recognizer_pop(rec->recognizer);
+            }
+
+            if (vosk_batch_recognizer_get_pending_chunks(rec->recognizer) > 0) {
+                pending = 1;
+            } else if (rec->finished && !rec->done_sent) {
+                if (!rec->drained) {
+                    // Results of chunks already in the GPU pipeline can arrive
+                    // after the pending count drops to 0: wait for the model
+                    // once more and drain again before sending :done
+                    rec->drained = 1;
+                    pending = 1;
+                } else {
+                    batch_send(engine, rec, enif_make_atom(engine->msg_env, "done"));
+                    rec->done_sent = 1;
+                }
+            }
+        }
+
+        if (pending) {
+            enif_mutex_unlock(engine->lock);
+            vosk_batch_model_wait(engine->model);
+            enif_mutex_lock(engine->lock);
+        } else if (!engine->has_work && engine->running) {
+            enif_cond_wait(engine->cond, engine->lock);
+        }
+    }
+    enif_mutex_unlock(engine->lock);
+
+    return NULL;
+}
+
+// Wake the batch worker after new audio or a finished stream
+static void batch_notify(BatchEngine* engine) {
+    engine->has_work = 1;
+    enif_cond_signal(engine->cond);
+}
+
+// Load batch (GPU) model (dirty IO NIF)
+static ERL_NIF_TERM load_batch_model_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    static int gpu_initialized = 0;
+    ErlNifBinary path_bin;
+    if (!enif_inspect_binary(env, argv[0], &path_bin)) {
+        return enif_make_badarg(env);
+    }
+
+    char path[1024];
+    if (path_bin.size >= sizeof(path)) {
+        return enif_make_badarg(env);
+    }
+    memcpy(path, path_bin.data, path_bin.size);
+    path[path_bin.size] = '\0';
+
+    // Best effort: racing first loads both call vosk_gpu_init, which only
+    // selects the device again
+    if (!gpu_initialized) {
+        vosk_gpu_init();
+        gpu_initialized = 1;
+    }
+
+    VoskBatchModel* model = vosk_batch_model_new(path);
+    if (model == NULL) {
+        return make_error(env, "model_load_failed");
+    }
+
+    BatchEngine* engine = enif_alloc(sizeof(BatchEngine));
+    if (engine == NULL) {
+        vosk_batch_model_free(model);
+        return make_error(env, "out_of_memory");
+    }
+    memset(engine, 0, sizeof(BatchEngine));
+    engine->model = model;
+    engine->lock = enif_mutex_create("vosk_batch_lock");
+    engine->cond = enif_cond_create("vosk_batch_cond");
+    engine->msg_env = enif_alloc_env();
+    engine->running = 1;
+
+    if (enif_thread_create("vosk_batch_worker", &engine->thread, batch_worker, engine, NULL) != 0) {
+        enif_free_env(engine->msg_env);
+        enif_cond_destroy(engine->cond);
+        enif_mutex_destroy(engine->lock);
+        enif_free(engine);
+        vosk_batch_model_free(model);
+        return make_error(env, "thread_create_failed");
+    }
+
+    BatchModelResource* res = enif_alloc_resource(BATCH_MODEL_TYPE, sizeof(BatchModelResource));
+    res->engine = engine;
+
+    ERL_NIF_TERM term = enif_make_resource(env, res);
+    enif_release_resource(res);
+
+    return enif_make_tuple2(env, enif_make_atom(env, "ok"), term);
+}
+
+// Create batch recognizer owned by the calling process
+static ERL_NIF_TERM create_batch_recognizer_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    BatchModelResource* model_res;
+    double sample_rate;
+
+    if (!enif_get_resource(env, argv[0], BATCH_MODEL_TYPE, (void**)&model_res) ||
+        !enif_get_double(env, argv[1], &sample_rate)) {
+        return enif_make_badarg(env);
+    }
+
+    BatchEngine* engine = model_res->engine;
+    enif_mutex_lock(engine->lock);
+    VoskBatchRecognizer* rec = vosk_batch_recognizer_new(engine->model, (float)sample_rate);
+    enif_mutex_unlock(engine->lock);
+
+    if (rec == NULL) {
+        return make_error(env, "recognizer_creation_failed");
+    }
+
+    BatchRecognizerResource* res = enif_alloc_resource(BATCH_RECOGNIZER_TYPE, sizeof(BatchRecognizerResource));
+    memset(res, 0, sizeof(BatchRecognizerResource));
+    res->recognizer = rec;
+    res->model = model_res;
+    enif_keep_resource(model_res);
+    enif_self(env, &res->owner);
+    res->tag_env = enif_alloc_env();
+    res->tag = enif_make_copy(res->tag_env, argv[2]);
+
+    enif_mutex_lock(engine->lock);
+    res->next = engine->recognizers;
+    engine->recognizers = res;
+    enif_mutex_unlock(engine->lock);
+
+    ERL_NIF_TERM term = enif_make_resource(env, res);
+    enif_release_resource(res);
+
+    return enif_make_tuple2(env, enif_make_atom(env, "ok"), term);
+}
+
+// Queue audio on a batch recognizer (dirty CPU NIF: copies into the GPU pipeline)
+static ERL_NIF_TERM batch_accept_waveform_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    BatchRecognizerResource* rec_res;
+    ErlNifBinary audio_data;
+
+    if (!enif_get_resource(env, argv[0], BATCH_RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_inspect_binary(env, argv[1], &audio_data)) {
+        return enif_make_badarg(env);
+    }
+
+    BatchEngine* engine = rec_res->model->engine;
+    enif_mutex_lock(engine->lock);
+    if (rec_res->finished) {
+        enif_mutex_unlock(engine->lock);
+        return make_error(env, "stream_finished");
+    }
+    vosk_batch_recognizer_accept_waveform(rec_res->recognizer, (const char*)audio_data.data, audio_data.size);
+    batch_notify(engine);
+    enif_mutex_unlock(engine->lock);
+
+    return enif_make_atom(env, "ok");
+}
+
+// Close a batch stream; the owner receives the remaining results and then :done
+static ERL_NIF_TERM batch_finish_stream_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    BatchRecognizerResource* rec_res;
+
+    if (!enif_get_resource(env, argv[0], BATCH_RECOGNIZER_TYPE, (void**)&rec_res)) {
+        return enif_make_badarg(env);
+    }
+
+    BatchEngine* engine = rec_res->model->engine;
+    enif_mutex_lock(engine->lock);
+    if (!rec_res->finished) {
+        vosk_batch_recognizer_finish_stream(rec_res->recognizer);
+        rec_res->finished = 1;
+        batch_notify(engine);
+    }
+    enif_mutex_unlock(engine->lock);
+
+    return enif_make_atom(env, "ok");
+}
+
+// Get number of audio chunks still waiting for the GPU
+static ERL_NIF_TERM batch_pending_chunks_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    BatchRecognizerResource* rec_res;
+
+    if (!enif_get_resource(env, argv[0], BATCH_RECOGNIZER_TYPE, (void**)&rec_res)) {
+        return enif_make_badarg(env);
+    }
+
+    BatchEngine* engine = rec_res->model->engine;
+    enif_mutex_lock(engine->lock);
+    int pending = vosk_batch_recognizer_get_pending_chunks(rec_res->recognizer);
+    enif_mutex_unlock(engine->lock);
+
+    return enif_make_int(env, pending);
+}
+
+// Async worker thread: runs queued accept_waveform jobs and reports each
+// result to the submitting process as {:vosk, recognizer_ref, result}.
+static void* async_worker(void* arg) {
+    ErlNifEnv* msg_env = enif_alloc_env();
+
+    enif_mutex_lock(async_pool.lock);
+    for (;;) {
+        while (async_pool.running && async_pool.ready_head == NULL) {
+            enif_cond_wait(async_pool.cond, async_pool.lock);
+        }
+        if (!async_pool.running) {
+            break;
+        }
+
+        RecognizerResource* res = async_pool.ready_head;
+        async_pool.ready_head = res->next_ready;
+        if (async_pool.ready_head == NULL) {
+            async_pool.ready_tail = NULL;
+        }
+        res->next_ready = NULL;
+
+        AsyncJob* job = res->jobs_head;
+        res->jobs_head = job->next;
+        if (res->jobs_head == NULL) {
+            res->jobs_tail = NULL;
+        }
+        enif_mutex_unlock(async_pool.lock);
+
+        recognizer_acquire_wait(res);
+        int result = feed_samples(res, job->audio.data, job->audio.size, SAMPLE_FORMAT_S16LE);
+        recognizer_release(res);
+
+        const char* outcome = result == 1 ? "utterance_ended" : result == 0 ? "continue" : "error";
+        ERL_NIF_TERM msg = enif_make_tuple3(msg_env,
+            enif_make_atom(msg_env, "vosk"),
+            enif_make_resource(msg_env, res),
+            enif_make_atom(msg_env, outcome));
+        enif_send(NULL, &job->reply_to, msg_env, msg);
+        enif_clear_env(msg_env);
+
+        enif_free_env(job->env);
+        enif_free(job);
+
+        enif_mutex_lock(async_pool.lock);
+        int drained = res->jobs_head == NULL;
+        if (drained) {
+            res->scheduled = 0;
+        } else {
+            // More audio for this recognizer: go to the back of the line
+            if (async_pool.ready_tail != NULL) {
+                async_pool.ready_tail->next_ready = res;
+            } else {
+                async_pool.ready_head = res;
+            }
+            async_pool.ready_tail = res;
+        }
+
+        if (drained) {
+            // Drop the reference taken when the recognizer was scheduled.
+            // Released outside the lock since it may run the destructor.
+            enif_mutex_unlock(async_pool.lock);
+            enif_release_resource(res);
+            enif_mutex_lock(async_pool.lock);
+        }
+    }
+    enif_mutex_unlock(async_pool.lock);
+
+    enif_free_env(msg_env);
+    return NULL;
+}
+
+// Start the async worker threads on first use. Called with async_pool.lock held.
+static int async_pool_start(void) {
+    int size = async_pool.size;
+    if (size <= 0) {
+        ErlNifSysInfo info;
+        enif_system_info(&info, sizeof(info));
+        size = info.scheduler_threads > 0 ? info.scheduler_threads : 1;
+    }
+
+    async_pool.threads = enif_alloc(sizeof(ErlNifTid) * size);
+    if (async_pool.threads == NULL) {
+        return 0;
+    }
+
+    async_pool.running = 1;
+    int created = 0;
+    for (; created < size; created++) {
+        if (enif_thread_create("vosk_async_worker", &async_pool.threads[created],
+                               async_worker, NULL, NULL) != 0) {
+            break;
+        }
+    }
+
+    if (created == 0) {
+        async_pool.running = 0;
+        enif_free(async_pool.threads);
+        async_pool.threads = NULL;
+        return 0;
+    }
+
+    async_pool.size = created;
+    async_pool.started = 1;
+    return 1;
+}
+
+// Stop and join the async worker threads (NIF unload)
+static void async_pool_stop(void) {
+    enif_mutex_lock(async_pool.lock);
+    int started = async_pool.started;
+    async_pool.running = 0;
+    enif_cond_broadcast(async_pool.cond);
+    enif_mutex_unlock(async_pool.lock);
+
+    if (started) {
+        for (int i = 0; i < async_pool.size; i++) {
+            enif_thread_join(async_pool.threads[i], NULL);
+        }
+        enif_free(async_pool.threads);
+        async_pool.threads = NULL;
+        async_pool.started = 0;
+    }
+}
+
+// Queue audio on the async worker pool; returns immediately
+static ERL_NIF_TERM accept_waveform_async_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
     RecognizerResource* rec_res;
 
-    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res)) {
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_is_binary(env, argv[1])) {
         return enif_make_badarg(env);
     }
 
-    vosk_recognizer_reset(rec_res->recognizer);
+    AsyncJob* job = enif_alloc(sizeof(AsyncJob));
+    if (job == NULL) {
+        return make_error(env, "out_of_memory");
+    }
+    job->env = enif_alloc_env();
+    job->next = NULL;
+    enif_self(env, &job->reply_to);
+    enif_inspect_binary(job->env, enif_make_copy(job->env, argv[1]), &job->audio);
+
+    enif_mutex_lock(async_pool.lock);
+    if (!async_pool.started && !async_pool_start()) {
+        enif_mutex_unlock(async_pool.lock);
+        enif_free_env(job->env);
+        enif_free(job);
+        return make_error(env, "thread_create_failed");
+    }
+
+    if (rec_res->jobs_tail != NULL) {
+        rec_res->jobs_tail->next = job;
+    } else {
+        rec_res->jobs_head = job;
+    }
+    rec_res->jobs_tail = job;
+
+    if (!rec_res->scheduled) {
+        rec_res->scheduled = 1;
+        enif_keep_resource(rec_res);
+        if (async_pool.ready_tail != NULL) {
+            async_pool.ready_tail->next_ready = rec_res;
+        } else {
+            async_pool.ready_head = rec_res;
+        }
+        async_pool.ready_tail = rec_res;
+        enif_cond_signal(async_pool.cond);
+    }
+    enif_mutex_unlock(async_pool.lock);
+
+    return enif_make_atom(env, "ok");
+}
+
+// Create an audio ring buffer for a recognizer.
+// argv: recognizer, capacity bytes, block bytes, sample format, notify pid or nil.
+static ERL_NIF_TERM create_audio_buffer_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    RecognizerResource* rec_res;
+    ErlNifUInt64 capacity;
+    ErlNifUInt64 block;
+    int format;
+    ErlNifPid notify_pid;
+    int notify = enif_get_local_pid(env, argv[4], &notify_pid);
+
+    if (!enif_get_resource(env, argv[0], RECOGNIZER_TYPE, (void**)&rec_res) ||
+        !enif_get_uint64(env, argv[1], &capacity) ||
+        !enif_get_uint64(env, argv[2], &block) ||
+        !enif_get_int(env, argv[3], &format) ||
+        (format != SAMPLE_FORMAT_S16LE && format != SAMPLE_FORMAT_F32LE) ||
+        block == 0 || block > ACCEPT_SLICE_BYTES || capacity < block) {
+        return enif_make_badarg(env);
+    }
+
+    AudioBufferResource* res = enif_alloc_resource(AUDIO_BUFFER_TYPE, sizeof(AudioBufferResource));
+    memset(res, 0, sizeof(AudioBufferResource));
+    res->block = (size_t)block;
+    res->capacity = (size_t)((capacity + block - 1) / block * block);
+    res->format = format;
+    res->notify = notify;
+    res->notify_pid = notify_pid;
+    res->lock = enif_mutex_create("vosk_audio_buffer_lock");
+    res->data = enif_alloc(res->capacity);
+    if (res->lock == NULL || res->data == NULL) {
+        enif_release_resource(res);
+        return make_error(env, "out_of_memory");
+    }
+    res->recognizer = rec_res;
+    enif_keep_resource(rec_res);
+
+    ERL_NIF_TERM term = enif_make_resource(env, res);
+    enif_release_resource(res);
+
+    return enif_make_tuple2(env, enif_make_atom(env, "ok"), term);
+}
+
+// Tell the buffer's decoder that at least one block is waiting
+static void audio_buffer_notify(ErlNifEnv* env, AudioBufferResource* res, ERL_NIF_TERM buffer) {
+    ERL_NIF_TERM msg = enif_make_tuple3(env,
+        enif_make_atom(env, "vosk_audio_buffer"),
+        buffer,
+        enif_make_atom(env, "ready"));
+    enif_send(env, &res->notify_pid, NULL, msg);
+}
+
+// Append audio (binary or iolist) to a ring buffer. A normal NIF: it only
+// copies bytes, so producers can call it for every packet. Returns :ok or
+// {:error, :overflow} when the audio does not fit (nothing is written).
+static ERL_NIF_TERM audio_buffer_append_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    AudioBufferResource* res;
+    ErlNifBinary audio;
+
+    if (!enif_get_resource(env, argv[0], AUDIO_BUFFER_TYPE, (void**)&res) ||
+        !enif_inspect_iolist_as_binary(env, argv[1], &audio)) {
+        return enif_make_badarg(env);
+    }
+
+    enif_mutex_lock(res->lock);
+    if (audio.size > res->capacity - res->count) {
+        res->overflows++;
+        enif_mutex_unlock(res->lock);
+        return make_error(env, "overflow");
+    }
+
+    size_t tail = (res->head + res->count) % res->capacity;
+    size_t first = res->capacity - tail;
+    if (first > audio.size) {
+        first = audio.size;
+    }
+    memcpy(res->data + tail, audio.data, first);
+    memcpy(res->data, audio.data + first, audio.size - first);
+
+    // Tell the decoder once per transition to "at least one block ready"
+    int ready = res->notify && res->count < res->block && res->count + audio.size >= res->block;
+    res->count += audio.size;
+    enif_mutex_unlock(res->lock);
+
+    if (ready) {
+        audio_buffer_notify(env, res, argv[0]);
+    }
+
     return enif_make_atom(env, "ok");
 }
 
+// Decode buffered audio in whole blocks, up to one accept slice per call
+// (dirty CPU NIF). argv: buffer, flush (0/1). With flush, a trailing partial
+// block is decoded too. Stops early when an utterance ends so its result can
+// be fetched. If a block or more is still buffered afterwards, the ready
+// message is sent again, since appends only send it when the buffer grows
+// past one block. Returns the accept_waveform status of the last block fed
+// (0 when nothing was fed) or {:error, :busy}.
+static ERL_NIF_TERM audio_buffer_drain_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    AudioBufferResource* res;
+    int flush;
+
+    if (!enif_get_resource(env, argv[0], AUDIO_BUFFER_TYPE, (void**)&res) ||
+        !enif_get_int(env, argv[1], &flush)) {
+        return enif_make_badarg(env);
+    }
+
+    RecognizerResource* rec_res = res->recognizer;
+    if (!recognizer_acquire(rec_res)) {
+        return make_error(env, "busy");
+    }
+
+    enif_mutex_lock(res->lock);
+    size_t head = res->head;
+    size_t available = res->count;
+    enif_mutex_unlock(res->lock);
+
+    size_t budget = ACCEPT_SLICE_BYTES - ACCEPT_SLICE_BYTES % res->block;
+    size_t frame = rec_res->dsp != NULL ? vosk_dsp_frame_bytes(rec_res->dsp, res->format)
+                 : res->format == SAMPLE_FORMAT_F32LE ? sizeof(float) : sizeof(short);
+    size_t consumed = 0;
+    int result = 0;
+
+    while (consumed < budget && result == 0) {
+        size_t len = available - consumed;
+        if (len >= res->block) {
+            len = res->block;
+        } else if (flush) {
+            // Whole frames only, so later reads stay frame aligned
+            len -= len % frame;
+        } else {
+            len = 0;
+        }
+        if (len == 0) {
+            break;
+        }
+
+        // The capacity is a multiple of the block size, so blocks normally end
+        // exactly at the end of the ring; after a flush raced an append they
+        // may not, so never read past it
+        size_t offset = (head + consumed) % res->capacity;
+        if (len > res->capacity - offset) {
+            len = res->capacity - offset;
+        }
+        result = feed_samples(rec_res, res->data + offset, len, res->format);
+        consumed += len;
+    }
+
+    // Advance before releasing the recognizer, or the next drain would feed
+    // the same bytes again
+    enif_mutex_lock(res->lock);
+    res->count -= consumed;
+    res->head = res->count == 0 ? 0 : (res->head + consumed) % res->capacity;
+    int ready = res->notify && consumed > 0 && res->count >= res->block;
+    enif_mutex_unlock(res->lock);
+    recognizer_release(rec_res);
+
+    if (ready) {
+        audio_buffer_notify(env, res, argv[0]);
+    }
+
+    return enif_make_int(env, result);
+}
+
+// Buffered bytes and overflow count: {pending, overflows}
+static ERL_NIF_TERM audio_buffer_info_nif(ErlNifEnv* env, int argc, const ERL_NIF_TERM argv[]) {
+    AudioBufferResource* res;
+
+    if (!enif_get_resource(env, argv[0], AUDIO_BUFFER_TYPE, (void**)&res)) {
+        return enif_make_badarg(env);
+    }
+
+    enif_mutex_lock(res->lock);
+    ErlNifUInt64 pending = res->count;
+    ErlNifUInt64 overflows = res->overflows;
+    enif_mutex_unlock(res->lock);
+
+    return enif_make_tuple2(env, enif_make_uint64(env, pending), enif_make_uint64(env, overflows));
+}
+
 // NIF initialization callback
 static int load(ErlNifEnv* env, void** priv_data, ERL_NIF_TERM load_info) {
-    // Set log level from load_info parameter (passed from Elixir)
-    // Default to -1 (silent) if not an integer
+    // load_info is a map of options passed from Elixir (a bare integer is
+    // still accepted as the log level). Defaults to -1 (silent) if missing.
     int log_level = -1;
-    if (!enif_get_int(env, load_info, &log_level)) {
+    int async_threads = 0;
+    ERL_NIF_TERM value;
+    if (enif_is_map(env, load_info)) {
+        if (enif_get_map_value(env, load_info, enif_make_atom(env, "log_level"), &value) &&
+            !enif_get_int(env, value, &log_level)) {
+            log_level = -1;
+        }
+        if (enif_get_map_value(env, load_info, enif_make_atom(env, "async_threads"), &value) &&
+            !enif_get_int(env, value, &async_threads)) {
+            async_threads = 0;
+        }
+    } else if (!enif_get_int(env, load_info, &log_level)) {
         log_level = -1;  // Default to silent if invalid
     }
     vosk_set_log_level(log_level);
 
+    recognizer_stats.lock = enif_mutex_create("vosk_stats_lock");
+    if (recognizer_stats.lock == NULL) {
+        return 1;
+    }
+
+    model_registry.lock = enif_mutex_create("vosk_model_registry_lock");
+    model_registry.cond = enif_cond_create("vosk_model_registry_cond");
+    if (model_registry.lock == NULL || model_registry.cond == NULL) {
+        return 1;
+    }
+
+    async_pool.lock = enif_mutex_create("vosk_async_lock");
+    async_pool.cond = enif_cond_create("vosk_async_cond");
+    async_pool.size = async_threads;
+    if (async_pool.lock == NULL || async_pool.cond == NULL) {
+        return 1;
+    }
+
     MODEL_TYPE = enif_open_resource_type(
         env, NULL, "VoskModel",
         model_destructor,
@@ -251,35 +2768,118 @@ static int load(ErlNifEnv* env, void** priv_data, ERL_NIF_TERM load_info) {
         NULL
     );
 
-    RECOGNIZER_TYPE = enif_open_resource_type(
-        env, NULL, "VoskRecognizer",
-        recognizer_destructor,
+    ErlNifResourceTypeInit recognizer_init = {recognizer_destructor, NULL, recognizer_down};
+    RECOGNIZER_TYPE = enif_open_resource_type_x(
+        env, "VoskRecognizer",
+        &recognizer_init,
+        ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER,
+        NULL
+    );
+
+    BATCH_MODEL_TYPE = enif_open_resource_type(
+        env, NULL, "VoskBatchModel",
+        batch_model_destructor,
+        ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER,
+        NULL
+    );
+
+    BATCH_RECOGNIZER_TYPE = enif_open_resource_type(
+        env, NULL, "VoskBatchRecognizer",
+        batch_recognizer_destructor,
+        ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER,
+        NULL
+    );
+
+    AUDIO_BUFFER_TYPE = enif_open_resource_type(
+        env, NULL, "VoskAudioBuffer",
+        audio_buffer_destructor,
+        ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER,
+        NULL
+    );
+
+    VOCABULARY_TYPE = enif_open_resource_type(
+        env, NULL, "VoskVocabulary",
+        vocabulary_destructor,
+        ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER,
+        NULL
+    );
+
+    SPK_MODEL_TYPE = enif_open_resource_type(
+        env, NULL, "VoskSpkModel",
+        spk_model_destructor,
         ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER,
         NULL
     );
 
-    if (MODEL_TYPE == NULL || RECOGNIZER_TYPE == NULL) {
+    if (MODEL_TYPE == NULL || RECOGNIZER_TYPE == NULL ||
+        BATCH_MODEL_TYPE == NULL || BATCH_RECOGNIZER_TYPE == NULL ||
+        AUDIO_BUFFER_TYPE == NULL || SPK_MODEL_TYPE == NULL || VOCABULARY_TYPE == NULL) {
         return 1;
     }
 
     return 0;
 }
 
+// NIF unload callback
+static void unload(ErlNifEnv* env, void* priv_data) {
+    async_pool_stop();
+    enif_cond_destroy(async_pool.cond);
+    enif_mutex_destroy(async_pool.lock);
+    enif_cond_destroy(model_registry.cond);
+    enif_mutex_destroy(model_registry.lock);
+    enif_mutex_destroy(recognizer_stats.lock);
+}
+
 // NIF function exports
 static ErlNifFunc nif_funcs[] = {
     {"set_log_level", 1, set_log_level_nif, 0},
-    {"load_model", 1, load_model_nif, 0},
+    {"load_model", 1, load_model_nif, ERL_NIF_DIRTY_JOB_IO_BOUND},
+    {"loaded_models", 0, loaded_models_nif, 0},
     {"find_word", 2, find_word_nif, 0},
-    {"create_recognizer", 2, create_recognizer_nif, 0},
+    {"find_words", 2, find_words_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"vocabulary", 1, vocabulary_nif, ERL_NIF_DIRTY_JOB_IO_BOUND},
+    {"create_recognizer", 2, create_recognizer_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"create_recognizer_grm", 3, create_recognizer_grm_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"load_spk_model", 1, load_spk_model_nif, ERL_NIF_DIRTY_JOB_IO_BOUND},
+    {"create_recognizer_spk", 3, create_recognizer_spk_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"set_spk_model", 2, set_spk_model_nif, 0},
+    {"set_grammar", 2, set_grammar_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
     {"set_max_alternatives", 2, set_max_alternatives_nif, 0},
     {"set_words", 2, set_words_nif, 0},
     {"set_partial_words", 2, set_partial_words_nif, 0},
-    {"accept_waveform", 2, accept_waveform_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"set_input_format", 3, set_input_format_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"enable_vad", 4, enable_vad_nif, 0},
+    {"vad_stats", 1, vad_stats_nif, 0},
+    {"set_endpointer", 4, set_endpointer_nif, 0},
+    {"audio_levels", 2, audio_levels_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"accept_waveform", 4, accept_waveform_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"accept_waveform_async", 2, accept_waveform_async_nif, 0},
+    {"create_audio_buffer", 5, create_audio_buffer_nif, 0},
+    {"audio_buffer_append", 2, audio_buffer_append_nif, 0},
+    {"audio_buffer_drain", 2, audio_buffer_drain_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"audio_buffer_info", 1, audio_buffer_info_nif, 0},
+    {"feed", 5, feed_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
     {"get_result", 1, get_result_nif, 0},
     {"get_partial_result", 1, get_partial_result_nif, 0},
     {"get_final_result", 1, get_final_result_nif, 0},
-    {"reset_recognizer", 1, reset_recognizer_nif, 0}
+    {"get_result_decoded", 2, get_result_decoded_nif, 0},
+    {"get_partial_result_decoded", 2, get_partial_result_decoded_nif, 0},
+    {"get_final_result_decoded", 2, get_final_result_decoded_nif, 0},
+    {"partial_result_if_changed", 2, partial_result_if_changed_nif, 0},
+    {"last_call_stats", 1, last_call_stats_nif, 0},
+    {"recognizer_stats", 1, recognizer_stats_nif, 0},
+    {"native_stats", 0, native_stats_nif, 0},
+    {"build_info", 0, build_info_nif, 0},
+    {"reset_recognizer", 1, reset_recognizer_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"enable_checkpoints", 2, enable_checkpoints_nif, 0},
+    {"checkpoint", 1, checkpoint_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"restore_checkpoint", 4, restore_checkpoint_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"load_batch_model", 1, load_batch_model_nif, ERL_NIF_DIRTY_JOB_IO_BOUND},
+    {"create_batch_recognizer", 3, create_batch_recognizer_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"batch_accept_waveform", 2, batch_accept_waveform_nif, ERL_NIF_DIRTY_JOB_CPU_BOUND},
+    {"batch_finish_stream", 1, batch_finish_stream_nif, 0},
+    {"batch_pending_chunks", 1, batch_pending_chunks_nif, 0}
 };
 
 // Initialize NIF module
-ERL_NIF_INIT(Elixir.VoskEx, nif_funcs, load, NULL, NULL, NULL)
+ERL_NIF_INIT(Elixir.VoskEx, nif_funcs, load, NULL, NULL, unload)
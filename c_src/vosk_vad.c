@@ -0,0 +1,452 @@
+#include "vosk_vad.h"
+#include "vosk_cpu.h"
+
+#include <erl_nif.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VAD_FRAME_MS 10
+
+// From decoded sample `decoded` on, `skipped` input samples have been dropped
+// in total. Entries are appended in order, one per silent run.
+typedef struct {
+    uint64_t decoded;
+    uint64_t skipped;
+} VadSkip;
+
+struct VoskVad {
+    int sample_rate;
+    size_t frame;             // samples per frame
+    double threshold;         // sum of squares per frame below which it is silence
+    uint64_t keep_frames;
+    size_t preroll_frames;
+    float* pending;           // partial frame carried between calls
+    size_t pending_count;
+    float* ring;              // held-back preroll frames
+    size_t ring_start;
+    size_t ring_count;
+    uint64_t silent_run;      // consecutive silent frames so far
+    uint64_t position;        // samples passed to the recognizer
+    uint64_t decoded_frames;
+    uint64_t skipped_frames;
+    VadSkip* skips;
+    size_t skip_count;
+    size_t skip_cap;
+    float* out;
+    size_t out_cap;
+};
+
+VoskVad* vosk_vad_create(int sample_rate, double threshold_db, int keep_ms, int preroll_ms) {
+    if (sample_rate < 1000 || keep_ms < 0 || preroll_ms < 0 || threshold_db > 0.0) {
+        return NULL;
+    }
+
+    VoskVad* vad = enif_alloc(sizeof(VoskVad));
+    if (vad == NULL) {
+        return NULL;
+    }
+    memset(vad, 0, sizeof(VoskVad));
+    vad->sample_rate = sample_rate;
+    vad->frame = (size_t)sample_rate * VAD_FRAME_MS / 1000;
+    vad->keep_frames = (uint64_t)(keep_ms / VAD_FRAME_MS);
+    vad->preroll_frames = (size_t)(preroll_ms / VAD_FRAME_MS);
+
+    // dBFS relative to a full-scale 16-bit sample, as a per-frame energy
+    double full_scale = 32768.0 * 32768.0;
+    vad->threshold = full_scale * pow(10.0, threshold_db / 10.0) * (double)vad->frame;
+
+    vad->pending = enif_alloc(vad->frame * sizeof(float));
+    vad->ring = enif_alloc((vad->preroll_frames * vad->frame + 1) * sizeof(float));
+    if (vad->pending == NULL || vad->ring == NULL) {
+        vosk_vad_destroy(vad);
+        return NULL;
+    }
+    return vad;
+}
+
+void vosk_vad_destroy(VoskVad* vad) {
+    if (vad == NULL) {
+        return;
+    }
+    if (vad->pending != NULL) enif_free(vad->pending);
+    if (vad->ring != NULL) enif_free(vad->ring);
+    if (vad->skips != NULL) enif_free(vad->skips);
+    if (vad->out != NULL) enif_free(vad->out);
+    enif_free(vad);
+}
+
+// Note `samples` dropped at the current decoded position
+static int record_skip(VoskVad* vad, uint64_t samples) {
+    if (vad->skip_count > 0 && vad->skips[vad->skip_count - 1].decoded == vad->position) {
+        vad->skips[vad->skip_count - 1].skipped += samples;
+        return 1;
+    }
+
+    if (vad->skip_count == vad->skip_cap) {
+        size_t cap = vad->skip_cap == 0 ? 16 : vad->skip_cap * 2;
+        VadSkip* skips = enif_realloc(vad->skips, cap * sizeof(VadSkip));
+        if (skips == NULL) {
+            return 0;
+        }
+        vad->skips = skips;
+        vad->skip_cap = cap;
+    }
+
+    uint64_t total = vad->skip_count > 0 ? vad->skips[vad->skip_count - 1].skipped : 0;
+    vad->skips[vad->skip_count].decoded = vad->position;
+    vad->skips[vad->skip_count].skipped = total + samples;
+    vad->skip_count++;
+    return 1;
+}
+
+static void emit(VoskVad* vad, const float* samples, size_t count, size_t* n) {
+    memcpy(vad->out + *n, samples, count * sizeof(float));
+    *n += count;
+    vad->position += count;
+}
+
+static void emit_frame(VoskVad* vad, const float* frame, size_t* n) {
+    emit(vad, frame, vad->frame, n);
+    vad->decoded_frames++;
+}
+
+// Drop a frame, or decode it anyway if the drop cannot be recorded
+static void skip_frame(VoskVad* vad, const float* frame, size_t* n) {
+    if (record_skip(vad, vad->frame)) {
+        vad->skipped_frames++;
+    } else {
+        emit_frame(vad, frame, n);
+    }
+}
+
+// Sum of squares of one frame, vectorized like the resampler's dot product
+VOSK_HOT static double frame_energy(const float* frame, size_t count) {
+    double energy = 0.0;
+#pragma omp simd reduction(+:energy)
+    for (size_t i = 0; i < count; i++) {
+        energy += (double)frame[i] * frame[i];
+    }
+    return energy;
+}
+
+static void handle_frame(VoskVad* vad, const float* frame, size_t* n) {
+    double energy = frame_energy(frame, vad->frame);
+
+    if (energy >= vad->threshold) {
+        // Speech: release the held-back lead-in first
+        while (vad->ring_count > 0) {
+            emit_frame(vad, vad->ring + vad->ring_start * vad->frame, n);
+            vad->ring_start = (vad->ring_start + 1) % vad->preroll_frames;
+            vad->ring_count--;
+        }
+        emit_frame(vad, frame, n);
+        vad->silent_run = 0;
+        return;
+    }
+
+    vad->silent_run++;
+    if (vad->silent_run <= vad->keep_frames) {
+        emit_frame(vad, frame, n);
+    } else if (vad->preroll_frames > 0) {
+        if (vad->ring_count == vad->preroll_frames) {
+            skip_frame(vad, vad->ring + vad->ring_start * vad->frame, n);
+            vad->ring_start = (vad->ring_start + 1) % vad->preroll_frames;
+            vad->ring_count--;
+        }
+        size_t slot = (vad->ring_start + vad->ring_count) % vad->preroll_frames;
+        memcpy(vad->ring + slot * vad->frame, frame, vad->frame * sizeof(float));
+        vad->ring_count++;
+    } else {
+        skip_frame(vad, frame, n);
+    }
+}
+
+void vosk_vad_reset(VoskVad* vad) {
+    // Buffered audio is discarded but still advances the input timeline
+    uint64_t dropped = (uint64_t)vad->ring_count * vad->frame + vad->pending_count;
+    if (dropped > 0 && record_skip(vad, dropped)) {
+        vad->skipped_frames += vad->ring_count;
+    }
+    vad->ring_start = 0;
+    vad->ring_count = 0;
+    vad->pending_count = 0;
+    vad->silent_run = 0;
+}
+
+static int reserve_out(VoskVad* vad, size_t needed) {
+    if (needed <= vad->out_cap) {
+        return 1;
+    }
+    size_t cap = vad->out_cap == 0 ? 4096 : vad->out_cap;
+    while (cap < needed) {
+        cap *= 2;
+    }
+    float* out = enif_realloc(vad->out, cap * sizeof(float));
+    if (out == NULL) {
+        return 0;
+    }
+    vad->out = out;
+    vad->out_cap = cap;
+    return 1;
+}
+
+int vosk_vad_process(VoskVad* vad, const float* in, size_t count, const float** out) {
+    // Worst case: all input, the pending frame and the whole preroll at once
+    if (!reserve_out(vad, count + vad->frame * (vad->preroll_frames + 1))) {
+        return -1;
+    }
+
+    size_t n = 0;
+    size_t i = 0;
+    while (i < count) {
+        size_t take = vad->frame - vad->pending_count;
+        if (take > count - i) {
+            take = count - i;
+        }
+        memcpy(vad->pending + vad->pending_count, in + i, take * sizeof(float));
+        vad->pending_count += take;
+        i += take;
+
+        if (vad->pending_count == vad->frame) {
+            handle_frame(vad, vad->pending, &n);
+            vad->pending_count = 0;
+        }
+    }
+
+    *out = vad->out;
+    return (int)n;
+}
+
+int vosk_vad_flush(VoskVad* vad, const float** out) {
+    if (!reserve_out(vad, vad->frame)) {
+        return -1;
+    }
+    size_t n = 0;
+    emit(vad, vad->pending, vad->pending_count, &n);
+    vad->pending_count = 0;
+    *out = vad->out;
+    return (int)n;
+}
+
+void vosk_vad_counters(const VoskVad* vad, uint64_t* decoded, uint64_t* skipped) {
+    *decoded = vad->decoded_frames;
+    *skipped = vad->skipped_frames;
+}
+
+VOSK_HOT size_t vosk_vad_levels_s16(const unsigned char* data, size_t len, int sample_rate, float* out) {
+    size_t frame = (size_t)sample_rate * VAD_FRAME_MS / 1000;
+    size_t frames = frame > 0 ? len / (frame * 2) : 0;
+    double full_scale = 32768.0 * 32768.0 * (double)frame;
+
+    for (size_t f = 0; f < frames; f++) {
+        const unsigned char* p = data + f * frame * 2;
+        double energy = 0.0;
+#pragma omp simd reduction(+:energy)
+        for (size_t i = 0; i < frame; i++) {
+            // Assembled from bytes, so unaligned input and big-endian hosts work
+            int16_t sample = (int16_t)(p[2 * i] | (p[2 * i + 1] << 8));
+            energy += (double)sample * sample;
+        }
+        out[f] = energy > 0.0 ? (float)(10.0 * log10(energy / full_scale)) : -120.0f;
+    }
+    return frames;
+}
+
+struct VoskEndpointer {
+    size_t frame;               // samples per frame
+    double threshold;           // sum of squares per frame below which it is silence
+    uint64_t trailing_frames;   // 0 = no trailing silence rule
+    uint64_t max_samples;       // 0 = no length limit
+    double energy;              // of the partial frame so far
+    size_t count;
+    int voiced;                 // speech seen in this utterance
+    uint64_t silent_run;        // silent frames since the last speech
+    uint64_t samples;           // since the utterance started
+};
+
+VoskEndpointer* vosk_endpointer_create(int sample_rate, double threshold_db,
+                                       int trailing_silence_ms, int max_utterance_ms) {
+    if (sample_rate < 1000 || threshold_db > 0.0 || trailing_silence_ms < 0 ||
+        max_utterance_ms < 0) {
+        return NULL;
+    }
+
+    VoskEndpointer* ep = enif_alloc(sizeof(VoskEndpointer));
+    if (ep == NULL) {
+        return NULL;
+    }
+    memset(ep, 0, sizeof(VoskEndpointer));
+    ep->frame = (size_t)sample_rate * VAD_FRAME_MS / 1000;
+    ep->threshold = 32768.0 * 32768.0 * pow(10.0, threshold_db / 10.0) * (double)ep->frame;
+    ep->trailing_frames = (uint64_t)((trailing_silence_ms + VAD_FRAME_MS - 1) / VAD_FRAME_MS);
+    ep->max_samples = (uint64_t)sample_rate * (uint64_t)max_utterance_ms / 1000;
+    return ep;
+}
+
+void vosk_endpointer_destroy(VoskEndpointer* ep) {
+    if (ep != NULL) {
+        enif_free(ep);
+    }
+}
+
+void vosk_endpointer_reset(VoskEndpointer* ep) {
+    ep->energy = 0.0;
+    ep->count = 0;
+    ep->voiced = 0;
+    ep->silent_run = 0;
+    ep->samples = 0;
+}
+
+int vosk_endpointer_process(VoskEndpointer* ep, const float* floats, const unsigned char* s16,
+                            size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        double x = floats != NULL ? (double)floats[i]
+                 : (double)(int16_t)(s16[2 * i] | (s16[2 * i + 1] << 8));
+        ep->energy += x * x;
+        ep->samples++;
+
+        if (++ep->count == ep->frame) {
+            if (ep->energy >= ep->threshold) {
+                ep->voiced = 1;
+                ep->silent_run = 0;
+            } else {
+                ep->silent_run++;
+            }
+            ep->energy = 0.0;
+            ep->count = 0;
+        }
+
+        // The rest of the input still belongs to the utterance that ended
+        if ((ep->voiced && ep->trailing_frames > 0 && ep->silent_run >= ep->trailing_frames) ||
+            (ep->max_samples > 0 && ep->samples >= ep->max_samples)) {
+            vosk_endpointer_reset(ep);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Map a decoded time in seconds to the input timeline. Word starts at a skip
+// point belong after it, word ends at a skip point belong before it.
+static double remap_time(const VoskVad* vad, double seconds, int is_end) {
+    if (vad == NULL) {
+        return seconds;
+    }
+    double position = seconds * vad->sample_rate;
+    size_t lo = 0;
+    size_t hi = vad->skip_count;
+
+    // Find the number of entries that apply at `position`
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        double at = (double)vad->skips[mid].decoded;
+        if (is_end ? at < position : at <= position) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == 0) {
+        return seconds;
+    }
+    return seconds + (double)vad->skips[lo - 1].skipped / vad->sample_rate;
+}
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} CharBuf;
+
+static int charbuf_append(CharBuf* buf, const char* s, size_t len) {
+    if (buf->len + len + 1 > buf->cap) {
+        size_t cap = buf->cap * 2;
+        while (cap < buf->len + len + 1) {
+            cap *= 2;
+        }
+        char* data = enif_realloc(buf->data, cap);
+        if (data == NULL) {
+            return 0;
+        }
+        buf->data = data;
+        buf->cap = cap;
+    }
+    memcpy(buf->data + buf->len, s, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+    return 1;
+}
+
+char* vosk_vad_remap_json(const VoskVad* vad, double offset, const char* json) {
+    if ((vad == NULL || vad->skip_count == 0) && offset == 0.0) {
+        return NULL;
+    }
+    if (json == NULL) {
+        return NULL;
+    }
+
+    size_t json_len = strlen(json);
+    CharBuf buf = {enif_alloc(json_len + 64), 0, json_len + 64};
+    if (buf.data == NULL) {
+        return NULL;
+    }
+
+    const char* p = json;
+    const char* end = json + json_len;
+    while (p < end) {
+        if (*p != '"') {
+            const char* next = memchr(p, '"', (size_t)(end - p));
+            if (next == NULL) {
+                next = end;
+            }
+            if (!charbuf_append(&buf, p, (size_t)(next - p))) goto fail;
+            p = next;
+            continue;
+        }
+
+        // Copy a string token, then check whether it keys a word time
+        const char* start = p++;
+        while (p < end && *p != '"') {
+            p += *p == '\\' && p + 1 < end ? 2 : 1;
+        }
+        p = p < end ? p + 1 : end;
+        size_t token_len = (size_t)(p - start);
+        if (!charbuf_append(&buf, start, token_len)) goto fail;
+
+        int is_start = token_len == 7 && memcmp(start, "\"start\"", 7) == 0;
+        int is_end = token_len == 5 && memcmp(start, "\"end\"", 5) == 0;
+        if (!is_start && !is_end) {
+            continue;
+        }
+
+        const char* q = p;
+        while (q < end && (*q == ' ' || *q == '\t' || *q == '\n' || *q == '\r')) q++;
+        if (q >= end || *q != ':') {
+            continue;
+        }
+        q++;
+        while (q < end && (*q == ' ' || *q == '\t' || *q == '\n' || *q == '\r')) q++;
+
+        char* number_end;
+        double seconds = strtod(q, &number_end);
+        if (number_end == q) {
+            continue;
+        }
+
+        char number[64];
+        double remapped = remap_time(vad, seconds, is_end) + offset;
+        int written = snprintf(number, sizeof(number), "%.6f", remapped);
+        if (!charbuf_append(&buf, p, (size_t)(q - p)) ||
+            !charbuf_append(&buf, number, (size_t)written)) goto fail;
+        p = number_end;
+    }
+
+    return buf.data;
+
+fail:
+    enif_free(buf.data);
+    return NULL;
+}
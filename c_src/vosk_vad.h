@@ -0,0 +1,80 @@
+#ifndef VOSK_VAD_H
+#define VOSK_VAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Energy gate in front of a recognizer. Audio is classified in 10 ms frames
+// by RMS level. The first `keep_ms` of every silent run are passed through
+// (libvosk needs trailing silence to detect the end of an utterance) and the
+// last `preroll_ms` are held back and released when speech resumes, so soft
+// onsets are not clipped. Everything in between is dropped before it reaches
+// the acoustic model.
+//
+// Dropped audio is recorded on a timeline so word times reported by libvosk,
+// which only sees the audio that was kept, can be mapped back to positions in
+// the original input.
+//
+// A gate is used by one recognizer at a time (under the recognizer lock) and
+// is not thread safe on its own.
+typedef struct VoskVad VoskVad;
+
+// Samples are mono floats in the 16-bit range at `sample_rate`.
+// `threshold_db` is the RMS level in dBFS below which a frame is silence.
+// Returns NULL on invalid arguments or allocation failure.
+VoskVad* vosk_vad_create(int sample_rate, double threshold_db, int keep_ms, int preroll_ms);
+
+void vosk_vad_destroy(VoskVad* vad);
+
+// Drop buffered audio, as when a recognizer is reset. The timeline and the
+// counters are kept, since libvosk keeps counting time across a reset.
+void vosk_vad_reset(VoskVad* vad);
+
+// Gate `count` samples. Returns the number of samples to decode and points
+// *out at them (valid until the next call), or -1 on allocation failure.
+// Up to one frame of input may be buffered until the next call.
+int vosk_vad_process(VoskVad* vad, const float* in, size_t count, const float** out);
+
+// Emit the buffered partial frame at the end of a stream
+int vosk_vad_flush(VoskVad* vad, const float** out);
+
+// Frames passed to the recognizer and frames dropped so far
+void vosk_vad_counters(const VoskVad* vad, uint64_t* decoded, uint64_t* skipped);
+
+// RMS level in dBFS of every whole 10 ms frame of s16le mono `data` at
+// `sample_rate`, for finding silence to split long recordings at. Writes
+// len / frame bytes values to `out` (a trailing partial frame is ignored) and
+// returns their count. Digital silence is reported as -120 dBFS.
+size_t vosk_vad_levels_s16(const unsigned char* data, size_t len, int sample_rate, float* out);
+
+// Endpointer ending utterances sooner (or later) than libvosk's built-in
+// rules, which cannot be tuned through its C API. It classifies the same
+// 10 ms frames by RMS level and fires once speech has been followed by
+// `trailing_silence_ms` of silence, or once an utterance reaches
+// `max_utterance_ms` (either 0 to disable). After firing, the next sample
+// starts a new utterance. Used under the recognizer lock like the gate.
+typedef struct VoskEndpointer VoskEndpointer;
+
+// Returns NULL on invalid arguments or allocation failure
+VoskEndpointer* vosk_endpointer_create(int sample_rate, double threshold_db,
+                                       int trailing_silence_ms, int max_utterance_ms);
+
+void vosk_endpointer_destroy(VoskEndpointer* ep);
+
+// Start a new utterance, as when libvosk ended one itself
+void vosk_endpointer_reset(VoskEndpointer* ep);
+
+// Observe `count` mono samples, given as floats in the 16-bit range or, when
+// `floats` is NULL, as s16le bytes. Returns 1 if the utterance should end.
+int vosk_endpointer_process(VoskEndpointer* ep, const float* floats, const unsigned char* s16,
+                            size_t count);
+
+// Rewrite the "start" and "end" word times in a libvosk JSON result from the
+// decoded timeline to the input timeline, then add `offset` seconds (for a
+// recognizer restored from a checkpoint). `vad` may be NULL to only shift.
+// Returns a string allocated with enif_alloc, or NULL when there is nothing
+// to rewrite or on allocation failure (the original JSON is then correct or
+// the best available).
+char* vosk_vad_remap_json(const VoskVad* vad, double offset, const char* json);
+
+#endif
@@ -0,0 +1,278 @@
+#include "vosk_vocab.h"
+
+#include <erl_nif.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// OpenFst binary format constants (fst.h, symbol-table.h)
+#define FST_MAGIC 2125659606
+#define SYMBOL_TABLE_MAGIC 2125658996
+#define FST_HAS_ISYMBOLS 0x1
+#define FST_HAS_OSYMBOLS 0x2
+
+// Bounds that reject corrupt files before they turn into huge allocations
+#define MAX_SYMBOL_LEN 4096
+#define MAX_SYMBOLS (1 << 24)
+
+typedef struct {
+    size_t offset;   // into text
+    size_t len;
+    int64_t key;
+} VocabEntry;
+
+// Symbols in file order, sorted by ID when the list is built
+typedef struct {
+    char* text;
+    size_t text_len;
+    size_t text_cap;
+    VocabEntry* entries;
+    size_t count;
+    size_t cap;
+    int64_t max_key;
+} VocabBuilder;
+
+static void builder_free(VocabBuilder* b) {
+    if (b->text != NULL) {
+        enif_free(b->text);
+    }
+    if (b->entries != NULL) {
+        enif_free(b->entries);
+    }
+}
+
+static int builder_add(VocabBuilder* b, const char* word, size_t len, int64_t key) {
+    if (key < 0 || key >= MAX_SYMBOLS || len > MAX_SYMBOL_LEN || memchr(word, '\n', len) != NULL) {
+        return 0;
+    }
+
+    if (b->count == b->cap) {
+        size_t cap = b->cap == 0 ? 1024 : b->cap * 2;
+        VocabEntry* entries = b->entries == NULL ? enif_alloc(cap * sizeof(VocabEntry))
+                                                 : enif_realloc(b->entries, cap * sizeof(VocabEntry));
+        if (entries == NULL) {
+            return 0;
+        }
+        b->entries = entries;
+        b->cap = cap;
+    }
+    if (b->text_len + len > b->text_cap) {
+        size_t cap = b->text_cap == 0 ? 16384 : b->text_cap;
+        while (cap < b->text_len + len) {
+            cap *= 2;
+        }
+        char* text = b->text == NULL ? enif_alloc(cap) : enif_realloc(b->text, cap);
+        if (text == NULL) {
+            return 0;
+        }
+        b->text = text;
+        b->text_cap = cap;
+    }
+
+    memcpy(b->text + b->text_len, word, len);
+    b->entries[b->count].offset = b->text_len;
+    b->entries[b->count].len = len;
+    b->entries[b->count].key = key;
+    b->text_len += len;
+    b->count++;
+    if (key > b->max_key) {
+        b->max_key = key;
+    }
+    return 1;
+}
+
+// Lay the symbols out by ID; a repeated ID keeps its last symbol
+static char* builder_finish(const VocabBuilder* b, size_t* len) {
+    if (b->count == 0) {
+        return NULL;
+    }
+
+    size_t slots = (size_t)b->max_key + 1;
+    size_t* by_key = enif_alloc(slots * sizeof(size_t));
+    if (by_key == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < slots; i++) {
+        by_key[i] = SIZE_MAX;
+    }
+    for (size_t i = 0; i < b->count; i++) {
+        by_key[b->entries[i].key] = i;
+    }
+
+    size_t total = slots - 1;
+    for (size_t i = 0; i < slots; i++) {
+        if (by_key[i] != SIZE_MAX) {
+            total += b->entries[by_key[i]].len;
+        }
+    }
+
+    char* out = enif_alloc(total > 0 ? total : 1);
+    if (out != NULL) {
+        char* p = out;
+        for (size_t i = 0; i < slots; i++) {
+            if (i > 0) {
+                *p++ = '\n';
+            }
+            if (by_key[i] != SIZE_MAX) {
+                const VocabEntry* e = &b->entries[by_key[i]];
+                memcpy(p, b->text + e->offset, e->len);
+                p += e->len;
+            }
+        }
+        *len = total;
+    }
+    enif_free(by_key);
+    return out;
+}
+
+// words.txt: one "<symbol> <id>" pair per line
+static int read_words_txt(FILE* f, VocabBuilder* b) {
+    char line[MAX_SYMBOL_LEN + 64];
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        size_t n = strlen(line);
+        if (n == sizeof(line) - 1 && line[n - 1] != '\n') {
+            return 0;
+        }
+        while (n > 0 && (line[n - 1] == '\n' || line[n - 1] == '\r' ||
+                         line[n - 1] == ' ' || line[n - 1] == '\t')) {
+            n--;
+        }
+        if (n == 0) {
+            continue;
+        }
+
+        size_t split = n;
+        while (split > 0 && line[split - 1] != ' ' && line[split - 1] != '\t') {
+            split--;
+        }
+        if (split == 0 || split == n) {
+            return 0;
+        }
+
+        line[n] = '\0';
+        char* end;
+        long long key = strtoll(line + split, &end, 10);
+        if (*end != '\0') {
+            return 0;
+        }
+
+        size_t word_len = split;
+        while (word_len > 0 && (line[word_len - 1] == ' ' || line[word_len - 1] == '\t')) {
+            word_len--;
+        }
+        if (word_len == 0 || !builder_add(b, line, word_len, (int64_t)key)) {
+            return 0;
+        }
+    }
+    return !ferror(f);
+}
+
+static int read_value(FILE* f, void* out, size_t size) {
+    return fread(out, 1, size, f) == size;
+}
+
+// OpenFst string: int32 length followed by the bytes. `buf` may be NULL to skip it.
+static int read_fst_string(FILE* f, char* buf, size_t cap, size_t* len) {
+    int32_t n;
+    if (!read_value(f, &n, sizeof(n)) || n < 0 || n > MAX_SYMBOL_LEN) {
+        return 0;
+    }
+    if (buf == NULL) {
+        return fseek(f, n, SEEK_CUR) == 0;
+    }
+    if ((size_t)n > cap || !read_value(f, buf, (size_t)n)) {
+        return 0;
+    }
+    *len = (size_t)n;
+    return 1;
+}
+
+// A binary symbol table; the entries of the table are added to `b` if it is not NULL
+static int read_symbol_table(FILE* f, VocabBuilder* b) {
+    int32_t magic;
+    int64_t available_key, size;
+    if (!read_value(f, &magic, sizeof(magic)) || magic != SYMBOL_TABLE_MAGIC ||
+        !read_fst_string(f, NULL, 0, NULL) ||
+        !read_value(f, &available_key, sizeof(available_key)) ||
+        !read_value(f, &size, sizeof(size)) || size < 0 || size > MAX_SYMBOLS) {
+        return 0;
+    }
+
+    char symbol[MAX_SYMBOL_LEN];
+    for (int64_t i = 0; i < size; i++) {
+        size_t len;
+        int64_t key;
+        if (!read_fst_string(f, symbol, sizeof(symbol), &len) ||
+            !read_value(f, &key, sizeof(key))) {
+            return 0;
+        }
+        if (b != NULL && !builder_add(b, symbol, len, key)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Only the FST header and the symbol tables after it are read, not the graph
+static int read_fst_osymbols(FILE* f, VocabBuilder* b) {
+    int32_t magic, version, flags;
+    uint64_t properties;
+    int64_t start, states, arcs;
+
+    if (!read_value(f, &magic, sizeof(magic)) || magic != FST_MAGIC ||
+        !read_fst_string(f, NULL, 0, NULL) ||   // FST type
+        !read_fst_string(f, NULL, 0, NULL) ||   // arc type
+        !read_value(f, &version, sizeof(version)) ||
+        !read_value(f, &flags, sizeof(flags)) ||
+        !read_value(f, &properties, sizeof(properties)) ||
+        !read_value(f, &start, sizeof(start)) ||
+        !read_value(f, &states, sizeof(states)) ||
+        !read_value(f, &arcs, sizeof(arcs)) ||
+        !(flags & FST_HAS_OSYMBOLS)) {
+        return 0;
+    }
+    if ((flags & FST_HAS_ISYMBOLS) && !read_symbol_table(f, NULL)) {
+        return 0;
+    }
+    return read_symbol_table(f, b);
+}
+
+char* vosk_vocab_read(const char* model_dir, size_t* len) {
+    static const struct {
+        const char* name;
+        int (*read)(FILE*, VocabBuilder*);
+    } sources[] = {
+        {"/graph/words.txt", read_words_txt},
+        {"/graph/Gr.fst", read_fst_osymbols},
+        {"/graph/HCLG.fst", read_fst_osymbols},
+    };
+
+    size_t dir_len = strlen(model_dir);
+    char* path = enif_alloc(dir_len + 32);
+    if (path == NULL) {
+        return NULL;
+    }
+
+    char* out = NULL;
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]) && out == NULL; i++) {
+        memcpy(path, model_dir, dir_len);
+        strcpy(path + dir_len, sources[i].name);
+
+        FILE* f = fopen(path, "rb");
+        if (f == NULL) {
+            continue;
+        }
+
+        VocabBuilder b = {0};
+        if (sources[i].read(f, &b)) {
+            out = builder_finish(&b, len);
+        }
+        builder_free(&b);
+        fclose(f);
+    }
+
+    enif_free(path);
+    return out;
+}
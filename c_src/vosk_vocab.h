@@ -0,0 +1,18 @@
+#ifndef VOSK_VOCAB_H
+#define VOSK_VOCAB_H
+
+#include <stddef.h>
+
+// Word list of a model directory, read the way libvosk finds it:
+// graph/words.txt if present, otherwise the output symbol table embedded in
+// graph/Gr.fst (lookahead models) or graph/HCLG.fst. libvosk does not expose
+// its symbol table through the C API, so this reads the files directly.
+//
+// The list is returned as one buffer allocated with enif_alloc, holding
+// every symbol from ID 0 to the largest ID separated by '\n', so line N is
+// the symbol with ID N (empty for unused IDs). Special symbols such as
+// <eps>, #0 and <unk> are included as the model defines them. Stores the
+// length in *len. Returns NULL if no word list is found or it is malformed.
+char* vosk_vocab_read(const char* model_dir, size_t* len);
+
+#endif
@@ -0,0 +1,156 @@
+defmodule Mix.Tasks.Vosk.PrepareModel do
+  @moduledoc """
+  Checks a downloaded Vosk model and converts its decoding graph to an
+  aligned constant FST.
+
+  ## Usage
+
+      mix vosk.prepare_model MODEL_PATH [--check] [--fstconvert PATH]
+
+  ## What it does
+
+  1. Verifies the model layout (acoustic model, feature config, graph).
+  2. Reads the OpenFst header of `graph/HCLG.fst` and reports its type.
+  3. Unless `--check` is given, converts a graph that is not an aligned
+     `const` FST with OpenFst's `fstconvert --fst_type=const --fst_align`,
+     replacing the file atomically.
+
+  A `const` FST is stored as flat state and arc arrays. OpenFst reads it with a
+  few bulk reads instead of rebuilding per-state vectors, which is most of the
+  graph's share of model load time. Alignment is what OpenFst needs to
+  memory-map the file, so a prepared model stays ready for page-cache sharing
+  across BEAM nodes once libvosk opens graphs in map mode. libvosk 0.3.45
+  still reads them into process memory.
+
+  Lookahead models (`graph/HCLr.fst` + `graph/Gr.fst`) use special FST types
+  and are checked but never converted.
+
+  ## Options
+
+  - `--check` - only report, do not modify the model
+  - `--fstconvert PATH` - the `fstconvert` binary to use (default: found on `PATH`)
+
+  ## Examples
+
+      mix vosk.prepare_model models/vosk-model-en-us-0.22
+      mix vosk.prepare_model models/vosk-model-en-us-0.22 --check
+  """
+
+  use Mix.Task
+
+  import Bitwise
+
+  @shortdoc "Checks a Vosk model and converts its graph to an aligned const FST"
+
+  # OpenFst binary header magic number and the "aligned" header flag
+  @fst_magic 2_125_659_606
+  @fst_aligned 4
+
+  @impl Mix.Task
+  def run(args) do
+    {opts, argv, _} =
+      OptionParser.parse(args, strict: [check: :boolean, fstconvert: :string])
+
+    model_path =
+      case argv do
+        [path] ->
+          path
+
+        _ ->
+          Mix.shell().error("Usage: mix vosk.prepare_model MODEL_PATH [--check]")
+          System.halt(1)
+      end
+
+    check_layout(model_path)
+
+    hclg = Path.join(model_path, "graph/HCLG.fst")
+
+    cond do
+      File.exists?(hclg) ->
+        prepare_graph(hclg, opts)
+
+      File.exists?(Path.join(model_path, "graph/HCLr.fst")) ->
+        Mix.shell().info("✓ Lookahead graph (HCLr.fst + Gr.fst); left as is")
+
+      true ->
+        Mix.shell().error("No decoding graph found in #{model_path}/graph")
+        System.halt(1)
+    end
+  end
+
+  defp check_layout(model_path) do
+    required = ["am/final.mdl", "conf/mfcc.conf"]
+
+    case Enum.reject(required, &File.exists?(Path.join(model_path, &1))) do
+      [] ->
+        Mix.shell().info("✓ Model layout looks complete: #{model_path}")
+
+      missing ->
+        Mix.shell().error("Not a Vosk model directory, missing: #{Enum.join(missing, ", ")}")
+        System.halt(1)
+    end
+  end
+
+  defp prepare_graph(path, opts) do
+    case read_fst_header(path) do
+      {:ok, "const", flags} when (flags &&& @fst_aligned) != 0 ->
+        Mix.shell().info("✓ #{path} is already an aligned const FST")
+
+      {:ok, type, _flags} ->
+        Mix.shell().info("• #{path} is a #{type} FST (not aligned const)")
+        unless opts[:check], do: convert(path, opts)
+
+      {:error, reason} ->
+        Mix.shell().error("Cannot read FST header of #{path}: #{reason}")
+        System.halt(1)
+    end
+  end
+
+  defp convert(path, opts) do
+    fstconvert = opts[:fstconvert] || System.find_executable("fstconvert")
+
+    if fstconvert == nil do
+      Mix.shell().error("fstconvert not found; install OpenFst or pass --fstconvert PATH.")
+      Mix.shell().info("Manual conversion:")
+      Mix.shell().info("  fstconvert --fst_type=const --fst_align #{path} #{path}.const")
+      Mix.shell().info("  mv #{path}.const #{path}")
+      System.halt(1)
+    end
+
+    tmp = path <> ".prepare"
+    Mix.shell().info("Converting #{path}...")
+
+    args = ["--fst_type=const", "--fst_align", path, tmp]
+
+    case System.cmd(fstconvert, args, stderr_to_stdout: true) do
+      {_output, 0} ->
+        File.rename!(tmp, path)
+        Mix.shell().info("✓ Converted to an aligned const FST")
+
+      {output, _} ->
+        File.rm(tmp)
+        Mix.shell().error("fstconvert failed:")
+        Mix.shell().error(output)
+        System.halt(1)
+    end
+  end
+
+  # Header layout: magic (int32), fst type and arc type (each an int32 length
+  # followed by bytes), version (int32), flags (int32), all little-endian
+  defp read_fst_header(path) do
+    with {:ok, file} <- File.open(path, [:read, :binary]) do
+      header = IO.binread(file, 256)
+      File.close(file)
+
+      case header do
+        <<@fst_magic::little-32, type_len::little-32, type::binary-size(type_len),
+          arc_len::little-32, _arc::binary-size(arc_len), _version::little-32,
+          flags::little-32, _::binary>> ->
+          {:ok, type, flags}
+
+        _ ->
+          {:error, :not_an_openfst_file}
+      end
+    end
+  end
+end
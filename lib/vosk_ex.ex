@@ -40,6 +40,14 @@ defmodule VoskEx do
     log_level: 0  # -1 = silent (default), 0 = default logging, >0 = more verbose
   ```
 
+  `VoskEx.Recognizer.accept_waveform_async/2` runs on a native thread pool,
+  separate from the BEAM dirty schedulers. Its size is read when the NIF loads:
+
+  ```elixir
+  config :vosk_ex,
+    async_threads: 8  # 0 = one thread per scheduler (default)
+  ```
+
   ## Quick Start
 
   ```elixir
@@ -112,10 +120,14 @@ defmodule VoskEx do
         _ -> :filename.join(priv_dir, ~c"vosk_nif")
       end
 
-    # Get log level from application config, default to -1 (silent)
-    log_level = Application.get_env(:vosk_ex, :log_level, -1)
+    # Native options from application config: log level defaults to -1
+    # (silent), async_threads to 0 (one async worker per scheduler)
+    load_info = %{
+      log_level: Application.get_env(:vosk_ex, :log_level, -1),
+      async_threads: Application.get_env(:vosk_ex, :async_threads, 0)
+    }
 
-    case :erlang.load_nif(nif_file, log_level) do
+    case :erlang.load_nif(nif_file, load_info) do
       :ok ->
         :ok
 
@@ -159,6 +171,78 @@ defmodule VoskEx do
     end
   end
 
+  @doc """
+  Transcribe a recording using several recognizers in parallel.
+
+  The file is split into segments of about `:segment_seconds` at its quietest
+  pauses, found with a native energy scan. Segments are decoded concurrently
+  on separate recognizers sharing `model`. Their results are joined in order,
+  with word times moved back onto the file's timeline. The file is read in
+  blocks by every pass and never loaded into memory whole.
+
+  `path` is a 16-bit mono PCM WAV file, or raw s16le audio at `:sample_rate`.
+
+  ## Options
+
+  - `:concurrency` - segments decoded at once (default:
+    `System.schedulers_online/0`). Decoding runs on dirty CPU schedulers, so
+    more than their count gains nothing.
+  - `:segment_seconds` - target segment length (default: `60`, at least `5`).
+    Each split point is searched within a quarter segment of its nominal
+    position, so a cut lands inside a word only if there was no pause there.
+  - `:words` - include word timings under `"result"` (default: `true`)
+  - `:sample_rate` - rate of raw files (default: `16000`); WAV files carry
+    their own
+
+  Returns `{:ok, %{"text" => text, "result" => words}}`, without `"result"`
+  when `words: false`.
+
+  ## Examples
+
+  ```elixir
+  {:ok, model} = VoskEx.Model.load("models/vosk-model-en-us-0.22")
+  {:ok, %{"text" => text}} = VoskEx.transcribe_file(model, "meeting.wav", concurrency: 16)
+  ```
+  """
+  @spec transcribe_file(VoskEx.Model.t(), Path.t(), keyword()) ::
+          {:ok, %{String.t() => any()}} | {:error, term()}
+  def transcribe_file(%VoskEx.Model{} = model, path, opts \\ []) do
+    VoskEx.FileTranscription.run(model, path, opts)
+  end
+
+  @doc """
+  Return node-wide native counters, for metrics exporters.
+
+  - `:samples_fed`, `:decode_ns`, `:utterances`, `:result_bytes` - totals
+    over every recognizer ever created on this node (see
+    `VoskEx.Recognizer.stats/1`)
+  - `:audio_seconds` - duration of the audio fed, summed over recognizers
+    of any sample rate
+  - `:recognizers` - live recognizers; one that keeps growing while traffic
+    is steady points at leaked recognizer handles
+  - `:recognizers_created` - recognizers created since the NIF was loaded
+  - `:models` - loaded models
+  - `:model_memory` - approximate native memory per loaded model path in
+    bytes, estimated from the size of its files when it was loaded
+
+  Reading the counters never waits on, or sends messages to, running decodes.
+
+  ## Examples
+
+  ```elixir
+  VoskEx.stats()
+  # => %{samples_fed: 96000000, audio_seconds: 6000.0, decode_ns: 412000000000,
+  #      utterances: 1830, result_bytes: 201342, recognizers: 12, recognizers_created: 40,
+  #      models: 1, model_memory: %{"/srv/models/vosk-model-en-us-0.22" => 2147483648}}
+  ```
+  """
+  @spec stats() :: %{atom() => number() | %{String.t() => non_neg_integer()}}
+  def stats do
+    # Model sizes are measured natively at load, so this does no file I/O
+    model_memory = Map.new(loaded_models(), &{&1.path, &1.files_bytes})
+    Map.put(native_stats(), :model_memory, model_memory)
+  end
+
   # NIF stub functions (replaced at runtime)
 
   @doc """
@@ -173,10 +257,19 @@ defmodule VoskEx do
   @doc """
   Load a Vosk model from a directory path.
 
+  Runs on a dirty IO scheduler, so large models do not block normal schedulers.
+  A path that is already loaded (compared after canonicalization) returns a
+  new handle to the same native model.
+
   Returns `{:ok, model_ref}` or `{:error, :model_load_failed}`.
   """
   def load_model(_path), do: :erlang.nif_error("NIF not loaded")
 
+  @doc """
+  List loaded models as `[%{path: canonical_path, handles: count, files_bytes: size}]`.
+  """
+  def loaded_models, do: :erlang.nif_error("NIF not loaded")
+
   @doc """
   Check if a word exists in the model vocabulary.
 
@@ -184,13 +277,77 @@ defmodule VoskEx do
   """
   def find_word(_model_ref, _word), do: :erlang.nif_error("NIF not loaded")
 
+  @doc """
+  Look up a list of words in the model vocabulary in one call.
+
+  Runs on a dirty CPU scheduler. Returns the symbols in list order, -1 for
+  words not found.
+  """
+  def find_words(_model_ref, _words), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Read the model's word list, one symbol per line, line N being symbol N.
+
+  Runs on a dirty IO scheduler the first time; the list is then kept with the
+  loaded model. Returns `{:ok, binary}` or `{:error, :vocabulary_unavailable}`.
+  """
+  def vocabulary(_model_ref), do: :erlang.nif_error("NIF not loaded")
+
   @doc """
   Create a recognizer for the given model and sample rate.
 
+  Runs on a dirty CPU scheduler.
+
   Returns `{:ok, recognizer_ref}` or `{:error, :recognizer_creation_failed}`.
   """
   def create_recognizer(_model_ref, _sample_rate), do: :erlang.nif_error("NIF not loaded")
 
+  @doc """
+  Create a recognizer restricted to a grammar.
+
+  The grammar is a JSON array of phrases, e.g. `~s(["one two three", "[unk]"])`.
+  Only models with lookahead graphs support grammars. Runs on a dirty CPU scheduler.
+
+  Returns `{:ok, recognizer_ref}` or `{:error, :recognizer_creation_failed}`.
+  """
+  def create_recognizer_grm(_model_ref, _sample_rate, _grammar_json),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Load a speaker identification model from a directory path.
+
+  Runs on a dirty IO scheduler.
+
+  Returns `{:ok, spk_model_ref}` or `{:error, :spk_model_load_failed}`.
+  """
+  def load_spk_model(_path), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Create a recognizer that also extracts speaker vectors.
+
+  Final results get `"spk"` (packed 32-bit floats when decoded natively) and
+  `"spk_frames"` keys. Runs on a dirty CPU scheduler.
+
+  Returns `{:ok, recognizer_ref}` or `{:error, :recognizer_creation_failed}`.
+  """
+  def create_recognizer_spk(_model_ref, _sample_rate, _spk_model_ref),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Attach a speaker model to an existing recognizer.
+
+  libvosk ignores it while an utterance is being decoded, so set it before
+  feeding audio or right after a result.
+  """
+  def set_spk_model(_recognizer_ref, _spk_model_ref), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Replace the grammar of an existing recognizer.
+
+  Pass `"[]"` to go back to the full model graph. Runs on a dirty CPU scheduler.
+  """
+  def set_grammar(_recognizer_ref, _grammar_json), do: :erlang.nif_error("NIF not loaded")
+
   @doc """
   Set maximum number of alternatives to return in results.
   """
@@ -207,38 +364,293 @@ defmodule VoskEx do
   def set_partial_words(_recognizer_ref, _enabled), do: :erlang.nif_error("NIF not loaded")
 
   @doc """
-  Process audio data (PCM 16-bit mono).
+  Configure the native downmix/resample stage for audio fed to a recognizer.
+
+  `input_rate` (integer Hz) and `channels` describe the audio that will be
+  fed. Audio at the recognizer's rate in mono removes the stage. Returns `:ok`,
+  `{:error, :invalid_input_format}` or `{:error, :busy}`.
+  """
+  def set_input_format(_recognizer_ref, _input_rate, _channels),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Enable the native silence gate on a recognizer that has not been fed yet.
+
+  `threshold_db` is a float in dBFS; `keep_ms` and `preroll_ms` are the
+  silence kept after speech and before speech resumes. Returns `:ok`,
+  `{:error, :invalid_vad_options}`, `{:error, :already_enabled}` or
+  `{:error, :busy}`.
+  """
+  def enable_vad(_recognizer_ref, _threshold_db, _keep_ms, _preroll_ms),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Return `{:ok, %{decoded_frames: n, skipped_frames: n}}` for a gated
+  recognizer, or `{:error, :vad_disabled}`.
+  """
+  def vad_stats(_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Configure the native endpointer of a recognizer.
+
+  `threshold_db` is a float in dBFS; `trailing_silence_ms` and
+  `max_utterance_ms` end utterances after that much silence following
+  speech, or at that length (`0` disables either, both `0` remove the
+  endpointer). Returns `:ok`, `{:error, :invalid_endpointer_options}` or
+  `{:error, :busy}`.
+  """
+  def set_endpointer(_recognizer_ref, _threshold_db, _trailing_silence_ms, _max_utterance_ms),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Return the RMS level of each 10 ms frame of s16le mono audio.
+
+  The result is a binary with one native-endian 32-bit float per frame, in
+  dBFS (`-120.0` for digital silence). Runs on a dirty CPU scheduler.
+  """
+  def audio_levels(_audio_binary, _sample_rate), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Process audio data (PCM mono, or interleaved when an input format is set).
+
+  `audio` may be a binary or an iolist. With `split` set to `1`, inputs
+  longer than 64 KiB are fed in slices, with the NIF rescheduling itself
+  between them and stopping at the first utterance end. Otherwise the whole
+  input is fed in one libvosk call.
+
+  `format` selects the sample layout: `0` for 16-bit signed little-endian
+  (the default), `1` for 32-bit float little-endian normalized to
+  `[-1.0, 1.0]`.
 
   Returns:
   - 1: utterance ended (silence detected)
+  - `{1, rest}`: with `split`, utterance ended before the end of a long
+    input; `rest` is the audio not yet fed
   - 0: continue processing
   - -1: error occurred
+  - `{:error, :busy}`: another call is using the recognizer
+
+  Every recognizer NIF returns `{:error, :busy}` instead of touching the
+  recognizer while another call on it is in progress.
   """
-  def accept_waveform(_recognizer_ref, _audio_binary), do: :erlang.nif_error("NIF not loaded")
+  def accept_waveform(_recognizer_ref, _audio, _format \\ 0, _split \\ 0),
+    do: :erlang.nif_error("NIF not loaded")
 
   @doc """
-  Get recognition result as JSON string.
+  Queue audio on the native async worker pool and return immediately.
+
+  The caller receives `{:vosk, recognizer_ref, :utterance_ended | :continue | :error}`
+  once the audio is decoded. Calls for the same recognizer are processed in order.
+
+  Returns `:ok`, `{:error, :thread_create_failed}` or `{:error, :out_of_memory}`.
+  """
+  def accept_waveform_async(_recognizer_ref, _audio_binary),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Create a native audio ring buffer feeding a recognizer.
+
+  `format` is `0` (s16le) or `1` (f32le); `notify` is a pid or `nil`.
+  Returns `{:ok, buffer_ref}` or `{:error, :out_of_memory}`.
+  """
+  def create_audio_buffer(_recognizer_ref, _capacity, _block_bytes, _format, _notify),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Copy audio (binary or iolist) into a ring buffer. Returns `:ok` or
+  `{:error, :overflow}`.
+  """
+  def audio_buffer_append(_buffer_ref, _audio), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Decode buffered audio in whole blocks (with `flush` 1, also a trailing
+  partial block). Returns 1, 0, -1 as `accept_waveform/3` or `{:error, :busy}`.
+  """
+  def audio_buffer_drain(_buffer_ref, _flush), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Return `{pending_bytes, overflows}` for a ring buffer.
+  """
+  def audio_buffer_info(_buffer_ref), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Process audio and fetch the matching result in a single dirty NIF call.
+
+  `want_partial` is `0`, `1` or `2` (only when changed, see
+  `partial_result_if_changed/2`); `decode` is `0` (JSON), `1` (native) or `2`
+  (native with word lists packed into `VoskEx.WordTimings`). Returns
+  `{:utterance, result}`, `{:partial, result}` (only when `want_partial` is
+  set), `:unchanged`, `:continue`, `:error` or `{:error, :busy}`. `result` is a decoded map when
+  `decode` is set, otherwise the JSON binary.
+
+  `audio` may be a binary or an iolist; `format` is as for `accept_waveform/4`.
+  The whole input is fed in one libvosk call.
+  """
+  def feed(_recognizer_ref, _audio, _want_partial, _decode, _format \\ 0),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Get recognition result as a JSON binary.
 
   Call this after accept_waveform returns 1.
   """
   def get_result(_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
 
   @doc """
-  Get partial recognition result as JSON string.
+  Get partial recognition result as a JSON binary.
 
   This can be called while recognition is in progress.
   """
   def get_partial_result(_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
 
   @doc """
-  Get final recognition result as JSON string.
+  Get final recognition result as a JSON binary.
 
   Call this at the end of the stream to flush remaining audio.
   """
   def get_final_result(_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
 
+  @doc """
+  Get recognition result decoded natively into maps and lists.
+
+  Returns `{:ok, map}` or `{:error, :invalid_json}`. Keys are binaries, matching
+  the shape produced by `Jason.decode/1` on `get_result/1`. With `pack_words`
+  set to `1`, word lists become `VoskEx.WordTimings` structs.
+  """
+  def get_result_decoded(_recognizer_ref, _pack_words), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Get partial recognition result decoded natively into maps and lists.
+
+  Returns `{:ok, map}` or `{:error, :invalid_json}`.
+  """
+  def get_partial_result_decoded(_recognizer_ref, _pack_words),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Get final recognition result decoded natively into maps and lists.
+
+  Returns `{:ok, map}` or `{:error, :invalid_json}`.
+  """
+  def get_final_result_decoded(_recognizer_ref, _pack_words),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Get the partial result unless it equals the one this function last returned.
+
+  `decode` is as in `feed/4`. Returns `:unchanged`, `{:ok, json}` when
+  `decode` is `0`, `{:ok, map}` otherwise, or `{:error, :busy}`.
+  """
+  def partial_result_if_changed(_recognizer_ref, _decode),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Return `{native_ns, audio_ns}` for the last call that used the recognizer.
+
+  `native_ns` is the time spent in libvosk and the input stage, measured with
+  a monotonic clock inside the NIF; `audio_ns` is the duration of the audio
+  the call fed. Used for `VoskEx.Telemetry` events. Never waits for a call in
+  progress.
+  """
+  def last_call_stats(_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Return the cumulative counters of a recognizer as a map.
+
+  Never waits for a call in progress.
+  """
+  def recognizer_stats(_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Return node-wide recognizer totals and recognizer and model counts as a map.
+  """
+  def native_stats, do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Return how the NIF was built.
+
+  - `:cpu_variants` - targets the audio kernels (resampler, downmix, frame
+    energy) were compiled for, e.g. `[:default, :avx2, :avx512f]`
+  - `:cpu_variant` - the one selected for this CPU when the NIF was loaded
+  - `:lto` - whether link-time optimization was on
+  - `:libvosk` - `:bundled` for the downloaded release, `:local` for a
+    library given with `VOSK_LIB_DIR`
+
+  See "Build options" in the README.
+
+  ## Examples
+
+  ```elixir
+  VoskEx.build_info()
+  #=> %{cpu_variants: [:default, :avx2, :avx512f], cpu_variant: :avx2,
+  #=>   lto: true, libvosk: :bundled}
+  ```
+  """
+  def build_info, do: :erlang.nif_error("NIF not loaded")
+
   @doc """
   Reset the recognizer to start fresh.
+
+  Runs on a dirty CPU scheduler.
   """
   def reset_recognizer(_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Keep up to `max_bytes` of the utterance in progress for checkpoints (0 disables).
+  """
+  def enable_checkpoints(_recognizer_ref, _max_bytes), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Return `{:ok, map}` with the audio of the utterance in progress and the
+  recognizer's settings, `{:error, :checkpoints_disabled}` or
+  `{:error, :tail_overflow}`. Runs on a dirty CPU scheduler.
+  """
+  def checkpoint(_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Replay a checkpoint's s16le audio into a recognizer with no utterance in
+  progress, shifting word times so they continue from `start` (in samples).
+
+  Returns the status integer of `accept_waveform/3`, or
+  `{:error, :sample_rate_mismatch | :not_idle | :busy}`. Runs on a dirty CPU
+  scheduler.
+  """
+  def restore_checkpoint(_recognizer_ref, _sample_rate, _audio, _start),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Load a batch (CUDA) model from a directory path.
+
+  Starts a native worker thread that delivers batch results as messages.
+  Returns `{:ok, batch_model_ref}` or `{:error, :model_load_failed}`, which is
+  also what libvosk builds without CUDA support return.
+  """
+  def load_batch_model(_path), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Create a batch recognizer owned by the calling process.
+
+  Results are sent to the caller as `{:vosk_batch, tag, {:result, map}}`,
+  followed by `{:vosk_batch, tag, :done}` once the stream is finished and drained.
+  """
+  def create_batch_recognizer(_batch_model_ref, _sample_rate, _tag),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Queue PCM 16-bit mono audio on a batch recognizer.
+
+  Returns `:ok` or `{:error, :stream_finished}`.
+  """
+  def batch_accept_waveform(_batch_recognizer_ref, _audio_binary),
+    do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Mark the end of a batch stream.
+  """
+  def batch_finish_stream(_batch_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
+
+  @doc """
+  Get the number of audio chunks still waiting to be decoded.
+  """
+  def batch_pending_chunks(_batch_recognizer_ref), do: :erlang.nif_error("NIF not loaded")
 end
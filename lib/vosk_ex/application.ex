@@ -10,14 +10,26 @@ defmodule VoskEx.Application do
     # Log level is configured during NIF load (see VoskEx.load_nifs/0)
     # Users can change it at runtime with VoskEx.set_log_level/1
 
-    children = [
-      # Starts a worker by calling: VoskEx.Worker.start_link(arg)
-      # {VoskEx.Worker, arg}
-    ]
+    children =
+      [
+        # Recognizer pools are started on demand by VoskEx.RecognizerPool.get/3
+        VoskEx.RecognizerPool,
+        # Streams started with VoskEx.Stream.start/1
+        {DynamicSupervisor, strategy: :one_for_one, name: VoskEx.StreamSupervisor}
+      ] ++ cluster_children()
 
     # See https://hexdocs.pm/elixir/Supervisor.html
     # for other strategies and supported options
     opts = [strategy: :one_for_one, name: VoskEx.Supervisor]
     Supervisor.start_link(children, opts)
   end
+
+  # VoskEx.Cluster is opt-in: config :vosk_ex, cluster: true | [interval: ms]
+  defp cluster_children do
+    case Application.get_env(:vosk_ex, :cluster, false) do
+      false -> []
+      true -> VoskEx.Cluster.child_specs([])
+      opts when is_list(opts) -> VoskEx.Cluster.child_specs(opts)
+    end
+  end
 end
@@ -0,0 +1,143 @@
+defmodule VoskEx.AudioBuffer do
+  @moduledoc """
+  Native ring buffer that collects audio for one recognizer.
+
+  Producers such as socket or port processes `append/2` packets as they
+  arrive. Appending only copies bytes into native memory on a normal
+  scheduler, so it is cheap enough to do per packet. A decoder process calls
+  `drain/2` at its own cadence, which decodes everything buffered in
+  fixed-size blocks in a single dirty NIF call. Packet arrival jitter no longer
+  dictates how often, or with how little audio, the decoder is entered.
+
+  ## Example
+
+  ```elixir
+  {:ok, rec} = VoskEx.Recognizer.new(model, 16000.0)
+  {:ok, buffer} = VoskEx.AudioBuffer.new(rec, notify: self())
+
+  # In the socket process
+  :ok = VoskEx.AudioBuffer.append(buffer, payload)
+
+  # In the decoder process
+  receive do
+    {:vosk_audio_buffer, _ref, :ready} ->
+      case VoskEx.AudioBuffer.drain(buffer) do
+        :utterance_ended -> VoskEx.Recognizer.result(buffer.recognizer)
+        :continue -> :ok
+      end
+  end
+  ```
+
+  The buffer keeps its recognizer alive. Use `buffer.recognizer` for results,
+  resets and other recognizer calls.
+  """
+
+  @enforce_keys [:ref, :recognizer]
+  defstruct [:ref, :recognizer]
+
+  @type t :: %__MODULE__{ref: reference(), recognizer: VoskEx.Recognizer.t()}
+
+  @doc """
+  Create a buffer feeding `recognizer`.
+
+  ## Options
+
+  - `:capacity` - maximum buffered bytes (default: `320_000`, 10 seconds of
+    16 kHz 16-bit mono); rounded up to a whole number of blocks
+  - `:block_bytes` - bytes decoded per step (default: `3200`, 100 ms of
+    16 kHz 16-bit mono). It must be a multiple of the frame size of the fed
+    audio, and at most 64 KiB
+  - `:format` - `:s16le` (default) or `:f32le`, as in
+    `VoskEx.Recognizer.accept_waveform/3`
+  - `:notify` - pid sent `{:vosk_audio_buffer, ref, :ready}` whenever the
+    buffered audio grows to at least one block, and after a `drain/2` that
+    leaves at least one block buffered, where `ref` is the buffer's `:ref`.
+    Draining once per message therefore decodes everything appended.
+  """
+  @spec new(VoskEx.Recognizer.t(), keyword()) :: {:ok, t()} | {:error, :out_of_memory}
+  def new(%VoskEx.Recognizer{ref: rec_ref} = recognizer, opts \\ []) do
+    format =
+      case Keyword.get(opts, :format, :s16le) do
+        :s16le -> 0
+        :f32le -> 1
+        other -> raise ArgumentError, "invalid :format option: #{inspect(other)}"
+      end
+
+    case VoskEx.create_audio_buffer(
+           rec_ref,
+           Keyword.get(opts, :capacity, 320_000),
+           Keyword.get(opts, :block_bytes, 3200),
+           format,
+           Keyword.get(opts, :notify)
+         ) do
+      {:ok, ref} -> {:ok, %__MODULE__{ref: ref, recognizer: recognizer}}
+      error -> error
+    end
+  end
+
+  @doc """
+  Append audio to the buffer.
+
+  Returns `{:error, :overflow}`, leaving the buffer unchanged, if the audio
+  does not fit; the decoder is falling behind.
+  """
+  @spec append(t(), iodata()) :: :ok | {:error, :overflow}
+  def append(%__MODULE__{ref: ref}, audio) when is_binary(audio) or is_list(audio) do
+    VoskEx.audio_buffer_append(ref, audio)
+  end
+
+  @doc """
+  Decode buffered audio in whole blocks.
+
+  Each call decodes up to 64 KiB and stops early when an utterance ends, so
+  its result can be fetched before the following audio is decoded. Call again
+  while `pending/1` is at least one block; with `:notify`, a new `:ready`
+  message is sent for that.
+
+  ## Options
+
+  - `:flush` - also decode a trailing partial block, e.g. at the end of a
+    stream (default: `false`)
+
+  ## Returns
+
+  Same as `VoskEx.Recognizer.accept_waveform/2`: `:utterance_ended`,
+  `:continue` (also when there was nothing to decode), `:error` or
+  `{:error, :busy}`.
+  """
+  @spec drain(t(), keyword()) :: :utterance_ended | :continue | :error | {:error, :busy}
+  def drain(%__MODULE__{ref: ref, recognizer: recognizer}, opts \\ []) do
+    flush = if Keyword.get(opts, :flush, false), do: 1, else: 0
+
+    VoskEx.Telemetry.span_decode([:vosk_ex, :audio_buffer, :drain, :stop], recognizer, fn ->
+      case VoskEx.audio_buffer_drain(ref, flush) do
+        1 -> :utterance_ended
+        0 -> :continue
+        -1 -> :error
+        {:error, :busy} = error -> error
+      end
+    end)
+  end
+
+  @doc """
+  Get the number of buffered bytes not yet decoded.
+  """
+  @spec pending(t()) :: non_neg_integer()
+  def pending(%__MODULE__{ref: ref}) do
+    {pending, _overflows} = VoskEx.audio_buffer_info(ref)
+    pending
+  end
+
+  @doc """
+  Get the number of appends rejected with `{:error, :overflow}` so far.
+  """
+  @spec overflows(t()) :: non_neg_integer()
+  def overflows(%__MODULE__{ref: ref}) do
+    {_pending, overflows} = VoskEx.audio_buffer_info(ref)
+    overflows
+  end
+
+  defimpl Inspect do
+    def inspect(%{ref: _}, _opts), do: "#VoskEx.AudioBuffer<...>"
+  end
+end
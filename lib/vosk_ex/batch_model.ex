@@ -0,0 +1,55 @@
+defmodule VoskEx.BatchModel do
+  @moduledoc """
+  High-level wrapper for a Vosk batch (GPU) model.
+
+  A batch model drives libvosk's CUDA batch decoder. Audio from many
+  `VoskEx.BatchRecognizer` streams is decoded together on the GPU, which makes
+  it a good fit for offline transcription of large numbers of recordings.
+
+  Each batch model owns a native worker thread that waits on the GPU and
+  delivers results to the processes owning the recognizers, so no BEAM
+  scheduler is blocked while decoding.
+
+  ## Requirements
+
+  Batch models require a libvosk build with CUDA support and a model prepared
+  for the batch decoder. The precompiled libraries downloaded by VoskEx are
+  CPU-only, so with them `load/1` returns `{:error, :model_load_failed}`.
+  """
+
+  @enforce_keys [:ref]
+  defstruct [:ref]
+
+  @type t :: %__MODULE__{ref: reference()}
+
+  @doc """
+  Load a batch model from a directory path.
+
+  ## Examples
+
+      iex> VoskEx.BatchModel.load("path/to/vosk-model-en-us-0.22")
+      {:ok, %VoskEx.BatchModel{}}
+  """
+  @spec load(String.t()) :: {:ok, t()} | {:error, :model_load_failed | atom()}
+  def load(path) when is_binary(path) do
+    case VoskEx.load_batch_model(path) do
+      {:ok, ref} -> {:ok, %__MODULE__{ref: ref}}
+      error -> error
+    end
+  end
+
+  @doc """
+  Load a batch model from a directory path, raising on error.
+  """
+  @spec load!(String.t()) :: t()
+  def load!(path) do
+    case load(path) do
+      {:ok, model} -> model
+      {:error, reason} -> raise "Failed to load batch model: #{reason}"
+    end
+  end
+
+  defimpl Inspect do
+    def inspect(%{ref: _}, _opts), do: "#VoskEx.BatchModel<...>"
+  end
+end
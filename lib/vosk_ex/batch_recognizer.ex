@@ -0,0 +1,103 @@
+defmodule VoskEx.BatchRecognizer do
+  @moduledoc """
+  High-level wrapper for a Vosk batch recognizer.
+
+  A batch recognizer represents one audio stream decoded by a
+  `VoskEx.BatchModel`. Audio is queued with `accept_waveform/2` and decoded
+  asynchronously; results are delivered to the process that created the
+  recognizer as messages:
+
+  - `{:vosk_batch, tag, {:result, map}}` - one per recognized utterance
+  - `{:vosk_batch, tag, :done}` - after `finish/1`, once all audio is decoded
+
+  `tag` is the value of the recognizer's `:tag` field (a fresh reference by default).
+
+  ## Example
+
+  ```elixir
+  {:ok, model} = VoskEx.BatchModel.load("models/vosk-model-en-us-0.22")
+
+  recognizers =
+    for path <- recordings do
+      {:ok, rec} = VoskEx.BatchRecognizer.new(model, 16000.0)
+      :ok = VoskEx.BatchRecognizer.accept_waveform(rec, File.read!(path))
+      :ok = VoskEx.BatchRecognizer.finish(rec)
+      rec
+    end
+
+  results = Enum.map(recognizers, &VoskEx.BatchRecognizer.await(&1, :timer.minutes(10)))
+  ```
+  """
+
+  @enforce_keys [:ref, :tag]
+  defstruct [:ref, :tag]
+
+  @type t :: %__MODULE__{ref: reference(), tag: term()}
+
+  @doc """
+  Create a batch recognizer owned by the calling process.
+
+  ## Options
+
+  - `:tag` - term included in every result message (default: a new reference)
+  """
+  @spec new(VoskEx.BatchModel.t(), number(), keyword()) ::
+          {:ok, t()} | {:error, :recognizer_creation_failed}
+  def new(%VoskEx.BatchModel{ref: model_ref}, sample_rate, opts \\ [])
+      when is_number(sample_rate) do
+    tag = Keyword.get_lazy(opts, :tag, &make_ref/0)
+
+    case VoskEx.create_batch_recognizer(model_ref, sample_rate / 1.0, tag) do
+      {:ok, ref} -> {:ok, %__MODULE__{ref: ref, tag: tag}}
+      error -> error
+    end
+  end
+
+  @doc """
+  Queue PCM 16-bit mono audio for decoding.
+  """
+  @spec accept_waveform(t(), binary()) :: :ok | {:error, :stream_finished}
+  def accept_waveform(%__MODULE__{ref: ref}, audio_data) when is_binary(audio_data) do
+    VoskEx.batch_accept_waveform(ref, audio_data)
+  end
+
+  @doc """
+  Mark the end of the stream. Remaining results follow, then `:done`.
+  """
+  @spec finish(t()) :: :ok
+  def finish(%__MODULE__{ref: ref}) do
+    VoskEx.batch_finish_stream(ref)
+  end
+
+  @doc """
+  Get the number of queued audio chunks not yet decoded.
+  """
+  @spec pending_chunks(t()) :: non_neg_integer()
+  def pending_chunks(%__MODULE__{ref: ref}) do
+    VoskEx.batch_pending_chunks(ref)
+  end
+
+  @doc """
+  Collect all results of a finished stream from the mailbox.
+
+  Call after `finish/1`. Returns `{:ok, results}` in arrival order, or
+  `{:error, :timeout}` if `:done` does not arrive within `timeout` milliseconds.
+  """
+  @spec await(t(), timeout()) :: {:ok, [map()]} | {:error, :timeout}
+  def await(%__MODULE__{tag: tag}, timeout \\ :infinity) do
+    collect(tag, timeout, [])
+  end
+
+  defp collect(tag, timeout, acc) do
+    receive do
+      {:vosk_batch, ^tag, {:result, result}} -> collect(tag, timeout, [result | acc])
+      {:vosk_batch, ^tag, :done} -> {:ok, Enum.reverse(acc)}
+    after
+      timeout -> {:error, :timeout}
+    end
+  end
+
+  defimpl Inspect do
+    def inspect(%{ref: _}, _opts), do: "#VoskEx.BatchRecognizer<...>"
+  end
+end
@@ -0,0 +1,250 @@
+defmodule VoskEx.Cluster do
+  @moduledoc """
+  Load-aware placement of streams across connected BEAM nodes.
+
+  Every node running the cluster process publishes a load report about once
+  a second to the others, through a `:pg` group. `pick/1` then chooses the
+  least loaded node that has a model loaded, and `start_stream/3` starts a
+  `VoskEx.Stream` there. A report contains:
+
+  - `:models` - names (directory basenames) of the models loaded on the node
+  - `:busy` - dirty CPU schedulers busy decoding on average since the last
+    report, from the native decode time in `VoskEx.stats/0`
+  - `:rtf` - real-time factor of the audio decoded since the last report
+    (`nil` if none)
+  - `:dirty_queue` - length of the dirty CPU run queue
+  - `:dirty_cpu_schedulers` - dirty CPU schedulers on the node
+  - `:free_pool_slots` - recognizers the node's `VoskEx.RecognizerPool`s can
+    still hand out before callers have to wait
+  - `:streams` - `VoskEx.Stream`s running under the `VoskEx` supervisor
+
+  A node's load is `(busy + dirty_queue + placed) / dirty_cpu_schedulers`,
+  where `placed` counts the streams this node has placed there since the
+  node's last report. Without it, a burst of placements between two reports
+  would all go to the same node. Ties go to the node with more free pool
+  slots. Reports older than three intervals are ignored, so nodes that went
+  away stop being picked.
+
+  ## Configuration
+
+  The cluster process is not started by default. Enable it on every node
+  that should take part:
+
+  ```elixir
+  config :vosk_ex, cluster: true
+  # or, with a report interval in milliseconds (default: 1000)
+  config :vosk_ex, cluster: [interval: 500]
+  ```
+
+  Nodes must be connected (for example with `libcluster`); the cluster
+  process only discovers VoskEx peers among them.
+
+  ## Example
+
+  ```elixir
+  {:ok, stream} =
+    VoskEx.Cluster.start_stream("vosk-model-en-us-0.22", sample_rate: 16000.0,
+      subscribers: [self()])
+
+  :ok = VoskEx.Stream.write(stream, chunk)
+  ```
+  """
+
+  use GenServer
+
+  @scope VoskEx.Cluster.Scope
+  @group :vosk_ex_nodes
+  @default_interval 1000
+
+  @type report :: %{
+          node: node(),
+          models: [String.t()],
+          busy: float(),
+          rtf: float() | nil,
+          dirty_queue: non_neg_integer(),
+          dirty_cpu_schedulers: pos_integer(),
+          free_pool_slots: non_neg_integer(),
+          streams: non_neg_integer()
+        }
+
+  @doc false
+  def child_specs(opts) do
+    [
+      %{id: :pg, start: {:pg, :start_link, [@scope]}},
+      {__MODULE__, opts}
+    ]
+  end
+
+  @doc false
+  def start_link(opts) do
+    GenServer.start_link(__MODULE__, opts, name: __MODULE__)
+  end
+
+  @doc """
+  Return the latest load report of every node, including this one.
+  """
+  @spec nodes() :: [report()]
+  def nodes do
+    GenServer.call(__MODULE__, :reports)
+  end
+
+  @doc """
+  Choose the least loaded node with `model_name` loaded.
+
+  `model_name` is the basename of the model directory, e.g.
+  `"vosk-model-small-en-us-0.15"`. The choice counts towards the node's load
+  until its next report.
+  """
+  @spec pick(String.t()) :: {:ok, node()} | {:error, :no_node}
+  def pick(model_name) when is_binary(model_name) do
+    GenServer.call(__MODULE__, {:pick, model_name})
+  end
+
+  @doc """
+  Start a `VoskEx.Stream` on the least loaded node with `model_name` loaded.
+
+  `stream_opts` are the options of `VoskEx.Stream.start/1`, without
+  `:model`, which is resolved on the chosen node.
+
+  Besides the errors of `pick/1` and `VoskEx.Stream.start/1`, returns
+  `{:error, reason}` with the `:erpc` reason (`:noconnection`, `:timeout`,
+  ...) when the node cannot be reached in time, and `{:error, {kind, reason}}`
+  when the start raised on the remote node.
+  """
+  @spec start_stream(String.t(), keyword(), timeout()) ::
+          {:ok, VoskEx.Stream.t()} | {:error, term()}
+  def start_stream(model_name, stream_opts, timeout \\ 5000) do
+    with {:ok, node} <- pick(model_name) do
+      remote_start(node, model_name, stream_opts, timeout)
+    end
+  end
+
+  # The chosen node may have gone away since its last report
+  defp remote_start(node, model_name, stream_opts, timeout) do
+    :erpc.call(node, __MODULE__, :start_local_stream, [model_name, stream_opts], timeout)
+  catch
+    :error, {:erpc, reason} -> {:error, reason}
+    kind, reason -> {:error, {kind, reason}}
+  end
+
+  @doc false
+  def start_local_stream(model_name, stream_opts) do
+    # Loading a path that is already loaded only returns a new handle
+    case Enum.find(VoskEx.Model.loaded(), &(Path.basename(&1.path) == model_name)) do
+      %{path: path} ->
+        with {:ok, model} <- VoskEx.Model.load(path) do
+          VoskEx.Stream.start([model: model] ++ stream_opts)
+        end
+
+      nil ->
+        {:error, :model_not_loaded}
+    end
+  end
+
+  @impl true
+  def init(opts) do
+    :ok = :pg.join(@scope, @group, self())
+
+    state = %{
+      interval: Keyword.get(opts, :interval, @default_interval),
+      # node => {report, received_at, placed}
+      reports: %{},
+      last_sample: sample()
+    }
+
+    send(self(), :report)
+    {:ok, state}
+  end
+
+  @impl true
+  def handle_call(:reports, _from, state) do
+    reports = for {_node, {report, _, _}} <- fresh(state), do: report
+    {:reply, reports, state}
+  end
+
+  def handle_call({:pick, model_name}, _from, state) do
+    candidates =
+      for {node, {report, _, _} = entry} <- fresh(state), model_name in report.models do
+        {node, entry}
+      end
+
+    case candidates do
+      [] ->
+        {:reply, {:error, :no_node}, state}
+
+      _ ->
+        {node, {report, received_at, placed}} =
+          Enum.min_by(candidates, fn {_node, {report, _, placed}} ->
+            {load(report, placed), -report.free_pool_slots}
+          end)
+
+        reports = Map.put(state.reports, node, {report, received_at, placed + 1})
+        {:reply, {:ok, node}, %{state | reports: reports}}
+    end
+  end
+
+  @impl true
+  def handle_info(:report, state) do
+    now = sample()
+    report = build_report(state.last_sample, now)
+
+    for pid <- :pg.get_members(@scope, @group), do: send(pid, {:vosk_cluster_report, report})
+
+    Process.send_after(self(), :report, state.interval)
+    {:noreply, %{state | last_sample: now}}
+  end
+
+  def handle_info({:vosk_cluster_report, report}, state) do
+    entry = {report, System.monotonic_time(:millisecond), 0}
+    {:noreply, %{state | reports: Map.put(state.reports, report.node, entry)}}
+  end
+
+  defp fresh(state) do
+    oldest = System.monotonic_time(:millisecond) - 3 * state.interval
+    Enum.filter(state.reports, fn {_node, {_, received_at, _}} -> received_at >= oldest end)
+  end
+
+  defp load(report, placed) do
+    (report.busy + report.dirty_queue + placed) / report.dirty_cpu_schedulers
+  end
+
+  defp sample do
+    stats = VoskEx.native_stats()
+    {System.monotonic_time(:nanosecond), stats.decode_ns, stats.audio_seconds}
+  end
+
+  defp build_report({time0, decode0, audio0}, {time1, decode1, audio1}) do
+    decode_ns = decode1 - decode0
+    audio_s = audio1 - audio0
+
+    # Dirty CPU and dirty IO run queues follow the normal ones
+    dirty_queue = :erlang.statistics(:run_queue_lengths_all) |> Enum.at(-2)
+
+    %{
+      node: node(),
+      models: Enum.map(VoskEx.Model.loaded(), &Path.basename(&1.path)),
+      busy: decode_ns / max(time1 - time0, 1),
+      rtf: if(audio_s > 0, do: decode_ns / 1.0e9 / audio_s),
+      dirty_queue: dirty_queue,
+      dirty_cpu_schedulers: :erlang.system_info(:dirty_cpu_schedulers),
+      free_pool_slots: free_pool_slots(),
+      streams: DynamicSupervisor.count_children(VoskEx.StreamSupervisor).active
+    }
+  end
+
+  defp free_pool_slots do
+    VoskEx.RecognizerPool.pools()
+    |> Enum.map(fn pool ->
+      # A pool that is busy or shutting down counts as full
+      try do
+        case VoskEx.RecognizerPool.status(pool) do
+          %{max: max, in_use: in_use} -> max - in_use
+          {:error, :pool_stopped} -> 0
+        end
+      catch
+        :exit, _ -> 0
+      end
+    end)
+    |> Enum.sum()
+  end
+end
@@ -0,0 +1,260 @@
+defmodule VoskEx.FileTranscription do
+  # Parallel transcription of one recording, see VoskEx.transcribe_file/3.
+  #
+  # A first pass streams the file through a native energy scan (one dBFS
+  # level per 10 ms frame). Split points are then picked at the quietest
+  # 300 ms near every nominal segment boundary, segments are decoded on
+  # separate recognizers sharing the model, and their word times are shifted
+  # back onto the file's timeline before the results are joined.
+  @moduledoc false
+
+  alias VoskEx.Recognizer
+
+  @frames_per_second 100
+  # Frames averaged when looking for a pause to split at
+  @quiet_frames 30
+  # Bytes read per call in both passes (about 20 s of 16 kHz mono)
+  @read_frames 2000
+
+  def run(%VoskEx.Model{} = model, path, opts) do
+    concurrency = Keyword.get(opts, :concurrency, System.schedulers_online())
+    segment_seconds = Keyword.get(opts, :segment_seconds, 60)
+    words = Keyword.get(opts, :words, true)
+
+    unless is_integer(concurrency) and concurrency > 0 do
+      raise ArgumentError, "invalid :concurrency option: #{inspect(concurrency)}"
+    end
+
+    unless is_number(segment_seconds) and segment_seconds >= 5 do
+      raise ArgumentError, "invalid :segment_seconds option: #{inspect(segment_seconds)}"
+    end
+
+    with {:ok, audio} <- open_audio(path, Keyword.get(opts, :sample_rate, 16000)),
+         {:ok, levels} <- scan_levels(audio) do
+      audio
+      |> segments(levels, round(segment_seconds * @frames_per_second))
+      |> Task.async_stream(&decode_segment(model, audio, &1, words),
+        max_concurrency: concurrency,
+        timeout: :infinity
+      )
+      |> Enum.reduce_while({:ok, []}, fn
+        {:ok, {:ok, results}}, {:ok, acc} -> {:cont, {:ok, [results | acc]}}
+        {:ok, {:error, reason}}, _ -> {:halt, {:error, reason}}
+      end)
+      |> case do
+        {:ok, results} -> {:ok, join(results |> Enum.reverse() |> Enum.concat(), words)}
+        error -> error
+      end
+    end
+  end
+
+  # Audio layout as %{path, offset, frames, frame_bytes, sample_rate}:
+  # offset is where samples start, frames counts whole 10 ms frames
+  defp open_audio(path, default_rate) do
+    with {:ok, %File.Stat{size: size}} <- File.stat(path),
+         {:ok, header} <- read_at(path, 0, 65_536),
+         {:ok, offset, data_size, sample_rate} <- layout(header, size, default_rate) do
+      frame_bytes = div(sample_rate, @frames_per_second) * 2
+
+      {:ok,
+       %{
+         path: path,
+         offset: offset,
+         frames: div(data_size, frame_bytes),
+         frame_bytes: frame_bytes,
+         sample_rate: sample_rate
+       }}
+    end
+  end
+
+  defp layout(<<"RIFF", _::little-32, "WAVE", chunks::binary>>, size, _default_rate) do
+    wav_chunks(chunks, 12, size, nil)
+  end
+
+  defp layout(_raw, size, sample_rate), do: {:ok, 0, size, sample_rate}
+
+  # Walk the RIFF chunks of the header up to "data", checking "fmt " on the way
+  defp wav_chunks(<<"fmt ", len::little-32, fmt::binary-size(len), rest::binary>>, at, size, _) do
+    case fmt do
+      # PCM, mono, any rate, 16 bits per sample
+      <<1::little-16, 1::little-16, rate::little-32, _::binary-size(6), 16::little-16,
+        _::binary>> ->
+        wav_chunks(rest, at + 8 + len, size, rate)
+
+      _ ->
+        {:error, :unsupported_wav_format}
+    end
+  end
+
+  defp wav_chunks(<<"data", len::little-32, _::binary>>, at, size, rate) when rate != nil do
+    {:ok, at + 8, min(len, size - at - 8), rate}
+  end
+
+  defp wav_chunks(<<id::binary-4, len::little-32, rest::binary>>, at, size, rate)
+       when id != "data" and byte_size(rest) >= len + rem(len, 2) do
+    # Chunks are padded to an even length
+    <<_::binary-size(len + rem(len, 2)), rest::binary>> = rest
+    wav_chunks(rest, at + 8 + len + rem(len, 2), size, rate)
+  end
+
+  defp wav_chunks(_, _, _, _), do: {:error, :unsupported_wav_format}
+
+  # Levels of the whole file as one binary of native floats, read in blocks
+  defp scan_levels(audio) do
+    with_file(audio.path, fn file ->
+      {:ok, _} = :file.position(file, audio.offset)
+      {:ok, scan_blocks(file, audio, audio.frames, [])}
+    end)
+  end
+
+  defp scan_blocks(_file, _audio, 0, acc), do: acc |> Enum.reverse() |> IO.iodata_to_binary()
+
+  defp scan_blocks(file, audio, frames_left, acc) do
+    frames = min(frames_left, @read_frames)
+
+    case :file.read(file, frames * audio.frame_bytes) do
+      {:ok, data} ->
+        levels = VoskEx.audio_levels(data, audio.sample_rate)
+        scan_blocks(file, audio, frames_left - frames, [levels | acc])
+
+      _ ->
+        scan_blocks(file, audio, 0, acc)
+    end
+  end
+
+  # Frame ranges {first, last} covering the file, split at pauses
+  defp segments(audio, levels, segment_frames) do
+    count = max(round(audio.frames / segment_frames), 1)
+    window = div(segment_frames, 4)
+
+    splits =
+      for k <- 1..(count - 1)//1 do
+        nominal = div(k * audio.frames, count)
+        quietest(levels, max(nominal - window, 0), min(nominal + window, audio.frames))
+      end
+
+    Enum.zip([0 | splits], splits ++ [audio.frames])
+  end
+
+  # Middle of the @quiet_frames run with the lowest total level in [from, to)
+  defp quietest(_levels, from, to) when to - from <= @quiet_frames, do: div(from + to, 2)
+
+  defp quietest(levels, from, to) do
+    window = binary_part(levels, from * 4, (to - from) * 4)
+    values = for <<level::float-native-32 <- window>>, do: level
+
+    {head, _} = Enum.split(values, @quiet_frames)
+    initial = Enum.sum(head)
+
+    {_, _, best} =
+      values
+      |> Enum.zip(Enum.drop(values, @quiet_frames))
+      |> Enum.with_index(1)
+      |> Enum.reduce({initial, initial, 0}, fn {{leaving, entering}, i}, {sum, best_sum, best} ->
+        sum = sum - leaving + entering
+        if sum < best_sum, do: {sum, sum, i}, else: {sum, best_sum, best}
+      end)
+
+    from + best + div(@quiet_frames, 2)
+  end
+
+  defp decode_segment(model, audio, {first, last}, words) do
+    with {:ok, rec} <- Recognizer.new(model, audio.sample_rate / 1) do
+      Recognizer.set_words(rec, words)
+      shift = first / @frames_per_second
+
+      with_file(audio.path, fn file ->
+        {:ok, _} = :file.position(file, audio.offset + first * audio.frame_bytes)
+
+        with {:ok, results} <- decode_blocks(file, rec, audio, last - first, []),
+             {:ok, final} <- Recognizer.final_result(rec) do
+          {:ok, Enum.map(Enum.reverse([final | results]), &shift_words(&1, shift))}
+        end
+      end)
+    end
+  end
+
+  defp decode_blocks(_file, _rec, _audio, 0, acc), do: {:ok, acc}
+
+  defp decode_blocks(file, rec, audio, frames_left, acc) do
+    frames = min(frames_left, @read_frames)
+
+    case :file.read(file, frames * audio.frame_bytes) do
+      {:ok, data} ->
+        with {:ok, acc} <- accept(rec, data, acc) do
+          decode_blocks(file, rec, audio, frames_left - frames, acc)
+        end
+
+      _ ->
+        {:ok, acc}
+    end
+  end
+
+  defp accept(rec, data, acc) do
+    case Recognizer.accept_waveform(rec, data, split: true) do
+      :continue ->
+        {:ok, acc}
+
+      :utterance_ended ->
+        with {:ok, result} <- Recognizer.result(rec), do: {:ok, [result | acc]}
+
+      {:utterance_ended, rest} ->
+        with {:ok, result} <- Recognizer.result(rec), do: accept(rec, rest, [result | acc])
+
+      :error ->
+        {:error, :decode_failed}
+
+      {:error, reason} ->
+        {:error, reason}
+    end
+  end
+
+  defp shift_words(%{"result" => words} = result, shift) when is_list(words) do
+    shifted =
+      Enum.map(words, fn word ->
+        %{word | "start" => word["start"] + shift, "end" => word["end"] + shift}
+      end)
+
+    %{result | "result" => shifted}
+  end
+
+  defp shift_words(result, _shift), do: result
+
+  defp join(results, words) do
+    text =
+      results
+      |> Enum.map(&Map.get(&1, "text", ""))
+      |> Enum.reject(&(&1 == ""))
+      |> Enum.join(" ")
+
+    if words do
+      %{"text" => text, "result" => Enum.flat_map(results, &Map.get(&1, "result", []))}
+    else
+      %{"text" => text}
+    end
+  end
+
+  defp read_at(path, position, bytes) do
+    with_file(path, fn file ->
+      case :file.pread(file, position, bytes) do
+        {:ok, data} -> {:ok, data}
+        :eof -> {:ok, <<>>}
+        error -> error
+      end
+    end)
+  end
+
+  defp with_file(path, fun) do
+    case File.open(path, [:read, :binary, :raw]) do
+      {:ok, file} ->
+        try do
+          fun.(file)
+        after
+          File.close(file)
+        end
+
+      error ->
+        error
+    end
+  end
+end
@@ -23,6 +23,14 @@ defmodule VoskEx.Model do
   Models are thread-safe and reference-counted by Vosk. You can safely share a model
   across multiple processes and recognizers. Resources are automatically cleaned up
   when no longer referenced.
+
+  ## Shared Loading
+
+  Loaded models are registered natively by canonical path. Loading a path that
+  is already loaded returns a handle to the same model instead of reading it
+  again, and concurrent loads of one path wait for a single read. The model is
+  freed once every handle has been garbage collected (and every recognizer
+  created from it is gone). See `loaded/0`.
   """
 
   @enforce_keys [:ref]
@@ -33,6 +41,17 @@ defmodule VoskEx.Model do
   @doc """
   Load a model from a directory path.
 
+  Loading runs on a dirty IO scheduler, so it never blocks normal schedulers,
+  but the calling process still waits until the model is ready. Every load
+  emits a `[:vosk_ex, :model, :load, :stop]` event, see `VoskEx.Telemetry`.
+
+  ## Options
+
+  - `:async` - when `true`, returns a reference immediately and loads the model
+    in a separate process. The caller receives
+    `{:vosk_model_loaded, ref, {:ok, model} | {:error, reason}}` when it
+    finishes. Use `await/2` to wait for it. Defaults to `false`.
+
   ## Examples
 
       iex> VoskEx.Model.load("path/to/vosk-model-small-en-us-0.15")
@@ -40,15 +59,84 @@ defmodule VoskEx.Model do
 
       iex> VoskEx.Model.load("invalid/path")
       {:error, :model_load_failed}
+
+      iex> ref = VoskEx.Model.load("path/to/vosk-model-small-en-us-0.15", async: true)
+      iex> VoskEx.Model.await(ref)
+      {:ok, %VoskEx.Model{}}
   """
-  @spec load(String.t()) :: {:ok, t()} | {:error, :model_load_failed}
-  def load(path) when is_binary(path) do
-    case VoskEx.load_model(path) do
-      {:ok, ref} -> {:ok, %__MODULE__{ref: ref}}
-      error -> error
+  @spec load(String.t(), keyword()) :: {:ok, t()} | {:error, :model_load_failed} | reference()
+  def load(path, opts \\ []) when is_binary(path) do
+    if Keyword.get(opts, :async, false) do
+      load_async(path)
+    else
+      started = System.monotonic_time()
+
+      result =
+        case VoskEx.load_model(path) do
+          {:ok, ref} -> {:ok, %__MODULE__{ref: ref}}
+          error -> error
+        end
+
+      :telemetry.execute(
+        [:vosk_ex, :model, :load, :stop],
+        %{duration: System.monotonic_time() - started},
+        %{path: path, result: if(match?({:ok, _}, result), do: :ok, else: elem(result, 1))}
+      )
+
+      result
     end
   end
 
+  @doc """
+  Wait for an asynchronous load started with `load(path, async: true)`.
+
+  Returns the load result, or `{:error, :timeout}` if it does not arrive in time.
+
+  ## Examples
+
+      iex> refs = Enum.map(paths, &VoskEx.Model.load(&1, async: true))
+      iex> Enum.map(refs, &VoskEx.Model.await/1)
+      [{:ok, %VoskEx.Model{}}, {:ok, %VoskEx.Model{}}]
+  """
+  @spec await(reference(), timeout()) ::
+          {:ok, t()} | {:error, :model_load_failed | :timeout}
+  def await(ref, timeout \\ :infinity) when is_reference(ref) do
+    receive do
+      {:vosk_model_loaded, ^ref, result} -> result
+    after
+      timeout -> {:error, :timeout}
+    end
+  end
+
+  defp load_async(path) do
+    caller = self()
+    ref = make_ref()
+
+    spawn(fn -> send(caller, {:vosk_model_loaded, ref, load(path)}) end)
+
+    ref
+  end
+
+  @doc """
+  List the models currently loaded on this node.
+
+  Each entry has the canonical `:path`, the number of live `:handles`,
+  i.e. `VoskEx.Model` structs returned by `load/2` not yet garbage collected,
+  and `:files_bytes`, the total size of the model's files measured when it
+  was loaded.
+
+  ## Examples
+
+      iex> VoskEx.Model.loaded()
+      [%{path: "/srv/models/vosk-model-en-us-0.22", handles: 3, files_bytes: 2147483648}]
+  """
+  @spec loaded() :: [
+          %{path: String.t(), handles: pos_integer(), files_bytes: non_neg_integer()}
+        ]
+  def loaded do
+    VoskEx.loaded_models()
+  end
+
   @doc """
   Check if a word exists in the model's vocabulary.
 
@@ -68,6 +156,61 @@ defmodule VoskEx.Model do
     VoskEx.find_word(ref, word)
   end
 
+  @doc """
+  Look up many words in the model's vocabulary at once.
+
+  Returns the symbol of every word in list order, -1 for words not found.
+  The whole list is looked up in a single call on a dirty CPU scheduler, so
+  checking a grammar or a hotword list of tens of thousands of terms costs
+  one NIF crossing instead of one per word.
+
+  ## Examples
+
+      iex> VoskEx.Model.find_words(model, ["hello", "xyzabc", "world"])
+      [42, -1, 97]
+
+      iex> missing =
+      ...>   terms
+      ...>   |> Enum.zip(VoskEx.Model.find_words(model, terms))
+      ...>   |> Enum.filter(fn {_term, symbol} -> symbol == -1 end)
+  """
+  @spec find_words(t(), [String.t()]) :: [integer()]
+  def find_words(%__MODULE__{ref: ref}, words) when is_list(words) do
+    VoskEx.find_words(ref, words)
+  end
+
+  @doc """
+  Return the model's whole vocabulary as one binary.
+
+  Symbols are separated by `"\\n"`, with line N holding the symbol with ID N
+  (as returned by `find_word/2`), so splitting the binary gives a list
+  indexed by symbol. Special symbols such as `<eps>`, `<unk>` and `#0` are
+  included as the model defines them. Use it for checks that
+  `find_words/2` cannot answer, such as prefix or fuzzy matching, without
+  a call into the model per candidate.
+
+  The list is read from the model directory (`graph/words.txt`, or the
+  symbol table stored in the decoding graph) on the first call and kept
+  with the loaded model, so later calls for any handle of the same model
+  return the same binary without copying it. Returns
+  `{:error, :vocabulary_unavailable}` if the model directory has no word
+  list.
+
+  ## Examples
+
+      iex> {:ok, vocabulary} = VoskEx.Model.vocabulary(model)
+      iex> words = :binary.split(vocabulary, "\\n", [:global])
+      iex> Enum.at(words, VoskEx.Model.find_word(model, "hello"))
+      "hello"
+
+      iex> Enum.filter(words, &String.starts_with?(&1, "hel"))
+      ["held", "hell", "hello", "helmet", ...]
+  """
+  @spec vocabulary(t()) :: {:ok, binary()} | {:error, :vocabulary_unavailable}
+  def vocabulary(%__MODULE__{ref: ref}) do
+    VoskEx.vocabulary(ref)
+  end
+
   @doc """
   Load a model from a directory path, raising on error.
 
@@ -27,8 +27,13 @@ defmodule VoskEx.Recognizer do
 
   ## Thread Safety
 
-  Recognizers are **NOT thread-safe**. Each process should create its own recognizer instance.
-  However, multiple recognizers can safely share the same model.
+  A recognizer decodes one call at a time. Each process should create its own
+  recognizer instance (or borrow one from `VoskEx.RecognizerPool`), while
+  multiple recognizers can safely share the same model.
+
+  Overlapping calls on the same recognizer, for example two processes sharing
+  it, do not corrupt its state: the call that finds the recognizer in use
+  returns `{:error, :busy}` without touching it.
 
   ## Example
 
@@ -64,8 +69,13 @@ defmodule VoskEx.Recognizer do
   defstruct [:ref]
 
   @type t :: %__MODULE__{ref: reference()}
-  @type waveform_result :: :utterance_ended | :continue | :error
+  @type waveform_result ::
+          :utterance_ended | {:utterance_ended, binary()} | :continue | :error | {:error, :busy}
   @type recognition_result :: %{optional(String.t()) => any()}
+  @type decode_error :: Jason.DecodeError.t() | :invalid_json | :busy
+
+  @default_checkpoint_seconds 30
+  @checkpoint_version 1
 
   @doc """
   Create a new recognizer for the given model and sample rate.
@@ -73,33 +83,235 @@ defmodule VoskEx.Recognizer do
   ## Parameters
 
   - `model`: A VoskEx.Model struct
-  - `sample_rate`: Audio sample rate in Hz (typically 8000, 16000, or 44100)
+  - `sample_rate`: Sample rate the recognizer decodes at, in Hz (typically
+    8000, 16000, or 44100; usually the rate the model was trained on)
+  - `opts`: input format options, see below
+
+  ## Options
+
+  Audio whose rate or channel count differs from the recognizer's can be
+  converted natively on the way in, instead of in a separate resampler process.
+  See `set_input_format/3`.
+
+  - `:input_rate` - sample rate of the audio that will be fed, in Hz
+    (default: `sample_rate`)
+  - `:channels` - interleaved channels in the audio that will be fed; they are
+    averaged to mono (default: `1`)
+  - `:vad` - `true` or a keyword list to enable the native silence gate, which
+    drops long silent stretches before they reach the acoustic model. Word
+    `"start"`/`"end"` times in results still refer to the original audio.
+    See `vad_stats/1` for its counters. Accepts:
+    - `:threshold` - RMS level in dBFS below which a 10 ms frame counts as
+      silence (default: `-45.0`)
+    - `:keep_ms` - silence kept at the start of every pause, which libvosk
+      needs to end utterances (default: `1000`)
+    - `:preroll_ms` - silence kept before speech resumes (default: `200`)
+
+  The gate is energy based: it skips silence and line noise well but passes
+  music, which still costs full decoding.
+
+  - `:endpointer` - keyword list to end utterances on tunable rules besides
+    libvosk's built-in ones, see `set_endpointer/2`
+
+  - `:grammar` - list of phrases the recognizer is restricted to, e.g.
+    `["yes", "no", "[unk]"]`; see `set_grammar/2`. Include `"[unk]"` to let
+    out-of-grammar speech come back as `"[unk]"` instead of the closest phrase.
+  - `:speaker_model` - a `VoskEx.SpkModel`; final results then include a
+    packed `"spk"` speaker vector, see `set_speaker_model/2`
+  - `:checkpoint` - `true` or a keyword list to keep the audio of the
+    utterance in progress, so `checkpoint/1` can move it to another
+    recognizer. Accepts:
+    - `:max_seconds` - longest utterance kept (default: `30`, about 1 MB at
+      16 kHz); `checkpoint/1` fails while a longer one is in progress
 
   ## Examples
 
       iex> model = VoskEx.Model.load!("path/to/model")
       iex> VoskEx.Recognizer.new(model, 16000.0)
       {:ok, %VoskEx.Recognizer{}}
+
+      iex> VoskEx.Recognizer.new(model, 16000.0, input_rate: 48000, channels: 2)
+      {:ok, %VoskEx.Recognizer{}}
+
+      iex> VoskEx.Recognizer.new(model, 8000.0, vad: [threshold: -40.0])
+      {:ok, %VoskEx.Recognizer{}}
+
+      iex> VoskEx.Recognizer.new(model, 8000.0, grammar: ["billing", "support", "[unk]"])
+      {:ok, %VoskEx.Recognizer{}}
+
+      iex> VoskEx.Recognizer.new(model, 16000.0, checkpoint: [max_seconds: 60])
+      {:ok, %VoskEx.Recognizer{}}
+
+      iex> VoskEx.Recognizer.new(model, 16000.0, endpointer: [trailing_silence_ms: 300])
+      {:ok, %VoskEx.Recognizer{}}
   """
-  @spec new(VoskEx.Model.t(), float()) :: {:ok, t()} | {:error, :recognizer_creation_failed}
-  def new(%VoskEx.Model{ref: model_ref}, sample_rate) when is_number(sample_rate) do
-    case VoskEx.create_recognizer(model_ref, sample_rate / 1.0) do
-      {:ok, ref} -> {:ok, %__MODULE__{ref: ref}}
-      error -> error
+  @spec new(VoskEx.Model.t(), float(), keyword()) ::
+          {:ok, t()}
+          | {:error,
+             :recognizer_creation_failed
+             | :invalid_input_format
+             | :invalid_vad_options
+             | :invalid_endpointer_options}
+  def new(%VoskEx.Model{ref: model_ref}, sample_rate, opts \\ []) when is_number(sample_rate) do
+    with {:ok, ref} <- create(model_ref, sample_rate / 1.0, opts),
+         recognizer = %__MODULE__{ref: ref},
+         :ok <- apply_speaker_model(recognizer, opts),
+         :ok <- apply_input_format(recognizer, sample_rate, opts),
+         :ok <- apply_vad(recognizer, Keyword.get(opts, :vad, false)),
+         :ok <- apply_checkpoint(recognizer, sample_rate, Keyword.get(opts, :checkpoint)),
+         :ok <- apply_endpointer(recognizer, Keyword.get(opts, :endpointer)) do
+      {:ok, recognizer}
     end
   end
 
+  defp create(model_ref, sample_rate, opts) do
+    case {opts[:grammar], opts[:speaker_model]} do
+      {nil, nil} ->
+        VoskEx.create_recognizer(model_ref, sample_rate)
+
+      {nil, %VoskEx.SpkModel{ref: spk_ref}} ->
+        VoskEx.create_recognizer_spk(model_ref, sample_rate, spk_ref)
+
+      {phrases, _} ->
+        VoskEx.create_recognizer_grm(model_ref, sample_rate, grammar_json(phrases))
+    end
+  end
+
+  # libvosk has no constructor taking both a grammar and a speaker model
+  defp apply_speaker_model(recognizer, opts) do
+    case {opts[:grammar], opts[:speaker_model]} do
+      {nil, _} -> :ok
+      {_phrases, nil} -> :ok
+      {_phrases, spk} -> set_speaker_model(recognizer, spk)
+    end
+  end
+
+  defp apply_input_format(recognizer, sample_rate, opts) do
+    case Keyword.take(opts, [:input_rate, :channels]) do
+      [] ->
+        :ok
+
+      format ->
+        input_rate = Keyword.get(format, :input_rate, sample_rate)
+        set_input_format(recognizer, input_rate, Keyword.get(format, :channels, 1))
+    end
+  end
+
+  defp apply_vad(_recognizer, false), do: :ok
+  defp apply_vad(recognizer, true), do: apply_vad(recognizer, [])
+
+  defp apply_vad(%__MODULE__{ref: ref}, vad_opts) when is_list(vad_opts) do
+    VoskEx.enable_vad(
+      ref,
+      Keyword.get(vad_opts, :threshold, -45.0) / 1.0,
+      Keyword.get(vad_opts, :keep_ms, 1000),
+      Keyword.get(vad_opts, :preroll_ms, 200)
+    )
+  end
+
+  defp apply_checkpoint(_recognizer, _sample_rate, nil), do: :ok
+  defp apply_checkpoint(_recognizer, _sample_rate, false), do: :ok
+  defp apply_checkpoint(rec, sample_rate, true), do: apply_checkpoint(rec, sample_rate, [])
+
+  defp apply_checkpoint(%__MODULE__{ref: ref}, sample_rate, checkpoint_opts)
+       when is_list(checkpoint_opts) do
+    max_seconds = Keyword.get(checkpoint_opts, :max_seconds, @default_checkpoint_seconds)
+
+    unless is_number(max_seconds) and max_seconds > 0 do
+      raise ArgumentError, "invalid :max_seconds checkpoint option: #{inspect(max_seconds)}"
+    end
+
+    # Two bytes per sample at the recognizer's rate
+    VoskEx.enable_checkpoints(ref, round(max_seconds * sample_rate) * 2)
+  end
+
+  defp apply_endpointer(_recognizer, nil), do: :ok
+  defp apply_endpointer(recognizer, ep_opts), do: set_endpointer(recognizer, ep_opts)
+
   @doc """
   Create a new recognizer, raising on error.
   """
-  @spec new!(VoskEx.Model.t(), float()) :: t()
-  def new!(model, sample_rate) do
-    case new(model, sample_rate) do
+  @spec new!(VoskEx.Model.t(), float(), keyword()) :: t()
+  def new!(model, sample_rate, opts \\ []) do
+    case new(model, sample_rate, opts) do
       {:ok, recognizer} -> recognizer
       {:error, reason} -> raise "Failed to create recognizer: #{reason}"
     end
   end
 
+  @doc """
+  Set the rate and channel count of the audio that will be fed.
+
+  Audio is downmixed to mono and resampled to the recognizer's sample rate
+  inside the NIF before it reaches libvosk, with filter state kept between
+  chunks. Input already at the recognizer's rate in mono bypasses the stage.
+  Applies to every `:format` accepted by `accept_waveform/3`.
+
+  Supported rates are 1 kHz to 384 kHz and up to 8 channels. Returns
+  `{:error, :invalid_input_format}` for values outside that range.
+
+  ## Examples
+
+      iex> VoskEx.Recognizer.set_input_format(recognizer, 8000, 1)
+      :ok
+  """
+  @spec set_input_format(t(), pos_integer(), pos_integer()) ::
+          :ok | {:error, :invalid_input_format | :busy}
+  def set_input_format(%__MODULE__{ref: ref}, input_rate, channels)
+      when is_number(input_rate) and is_integer(channels) do
+    VoskEx.set_input_format(ref, round(input_rate), channels)
+  end
+
+  @doc """
+  Tune when utterances end.
+
+  libvosk ends an utterance on fixed rules that wait for a long pause,
+  often half a second or more after the speaker stopped. Its C API does not
+  expose them, so this adds a native endpointer in front of it that looks
+  at the audio level of each 10 ms frame (after the input stage, before the
+  silence gate). Whichever fires first ends the utterance: `accept_waveform/3`
+  and friends report `:utterance_ended` and `result/2` returns it as usual.
+  Set it at any time, for example shorter while waiting for a yes/no answer;
+  the utterance in progress starts counting again.
+
+  ## Options
+
+  - `:trailing_silence_ms` - end the utterance after this much silence
+    following speech; `nil` leaves it to libvosk (default: `nil`)
+  - `:max_utterance_ms` - end utterances when they reach this length, which
+    bounds the lattice and memory of a runaway utterance (default: `nil`)
+  - `:threshold` - RMS level in dBFS below which a frame counts as silence
+    (default: `-45.0`); raise it on noisy lines
+
+  `set_endpointer(recognizer, [])` removes the endpointer. Utterance ends
+  are noticed at the end of each fed chunk, so feed chunks shorter than the
+  trailing silence (20-100 ms is typical for streaming).
+
+  ## Examples
+
+      iex> VoskEx.Recognizer.set_endpointer(recognizer, trailing_silence_ms: 250,
+      ...>   max_utterance_ms: 15_000)
+      :ok
+  """
+  @spec set_endpointer(t(), keyword()) :: :ok | {:error, :invalid_endpointer_options | :busy}
+  def set_endpointer(%__MODULE__{ref: ref}, opts) when is_list(opts) do
+    VoskEx.set_endpointer(
+      ref,
+      Keyword.get(opts, :threshold, -45.0) / 1.0,
+      endpointer_ms(opts, :trailing_silence_ms),
+      endpointer_ms(opts, :max_utterance_ms)
+    )
+  end
+
+  # The NIF takes 0 for a disabled rule
+  defp endpointer_ms(opts, key) do
+    case Keyword.get(opts, key) do
+      nil -> 0
+      ms when is_integer(ms) and ms > 0 -> ms
+      other -> raise ArgumentError, "invalid #{inspect(key)} option: #{inspect(other)}"
+    end
+  end
+
   @doc """
   Set maximum number of recognition alternatives to return.
 
@@ -108,11 +320,65 @@ defmodule VoskEx.Recognizer do
       iex> VoskEx.Recognizer.set_max_alternatives(recognizer, 3)
       :ok
   """
-  @spec set_max_alternatives(t(), integer()) :: :ok
+  @spec set_max_alternatives(t(), integer()) :: :ok | {:error, :busy}
   def set_max_alternatives(%__MODULE__{ref: ref}, max) when is_integer(max) do
     VoskEx.set_max_alternatives(ref, max)
   end
 
+  @doc """
+  Restrict the recognizer to a list of phrases.
+
+  Only the words of the given phrases can be recognized, which makes decoding
+  faster and far more accurate for small vocabularies such as IVR menus.
+  Pass `[]` to go back to the model's full graph. libvosk compiles the
+  grammar when it is set, so recognizers that keep the same phrase list are
+  best reused through `VoskEx.RecognizerPool` (see its `:grammar` option)
+  rather than rebuilt per call.
+
+  Grammars need a model with a lookahead graph (the small models have one);
+  other models ignore them. Words missing from the model's vocabulary are
+  dropped by libvosk with a warning, see `VoskEx.Model.find_word/2`.
+
+  ## Examples
+
+      iex> VoskEx.Recognizer.set_grammar(recognizer, ["one", "two", "three", "[unk]"])
+      :ok
+  """
+  @spec set_grammar(t(), [String.t()]) :: :ok | {:error, :busy | :out_of_memory}
+  def set_grammar(%__MODULE__{ref: ref}, phrases) when is_list(phrases) do
+    VoskEx.set_grammar(ref, grammar_json(phrases))
+  end
+
+  defp grammar_json(phrases) when is_list(phrases) do
+    unless Enum.all?(phrases, &is_binary/1) do
+      raise ArgumentError, "expected :grammar to be a list of strings, got: #{inspect(phrases)}"
+    end
+
+    Jason.encode!(phrases)
+  end
+
+  defp grammar_json(other) do
+    raise ArgumentError, "expected :grammar to be a list of strings, got: #{inspect(other)}"
+  end
+
+  @doc """
+  Attach a speaker identification model.
+
+  Final results then include `"spk"`, the utterance's speaker vector as a
+  binary of native-endian 32-bit floats (with either decoder), and
+  `"spk_frames"`. See `VoskEx.SpkModel`. libvosk only accepts the model
+  between utterances, so set it before feeding audio.
+
+  ## Examples
+
+      iex> VoskEx.Recognizer.set_speaker_model(recognizer, spk_model)
+      :ok
+  """
+  @spec set_speaker_model(t(), VoskEx.SpkModel.t()) :: :ok | {:error, :busy}
+  def set_speaker_model(%__MODULE__{ref: ref}, %VoskEx.SpkModel{ref: spk_ref}) do
+    VoskEx.set_spk_model(ref, spk_ref)
+  end
+
   @doc """
   Enable or disable word timing information in results.
 
@@ -123,7 +389,7 @@ defmodule VoskEx.Recognizer do
       iex> VoskEx.Recognizer.set_words(recognizer, true)
       :ok
   """
-  @spec set_words(t(), boolean()) :: :ok
+  @spec set_words(t(), boolean()) :: :ok | {:error, :busy}
   def set_words(%__MODULE__{ref: ref}, enabled) when is_boolean(enabled) do
     VoskEx.set_words(ref, if(enabled, do: 1, else: 0))
   end
@@ -136,7 +402,7 @@ defmodule VoskEx.Recognizer do
       iex> VoskEx.Recognizer.set_partial_words(recognizer, true)
       :ok
   """
-  @spec set_partial_words(t(), boolean()) :: :ok
+  @spec set_partial_words(t(), boolean()) :: :ok | {:error, :busy}
   def set_partial_words(%__MODULE__{ref: ref}, enabled) when is_boolean(enabled) do
     VoskEx.set_partial_words(ref, if(enabled, do: 1, else: 0))
   end
@@ -146,27 +412,221 @@ defmodule VoskEx.Recognizer do
 
   ## Parameters
 
-  - `audio_data`: Binary containing PCM 16-bit mono audio data
+  - `audio_data`: PCM mono audio data, as a binary or iodata (for example a
+    list of RTP payloads, which is not flattened in Elixir)
+  - `opts`: see Options below
+
+  ## Options
+
+  - `:format` - sample layout of `audio_data`:
+    - `:s16le` (default) - 16-bit signed little-endian integers
+    - `:f32le` - 32-bit little-endian floats normalized to `[-1.0, 1.0]`, as
+      produced by most media pipelines; passed to libvosk's float entry point
+      without converting to 16-bit integers first
+  - `:split` - when `true`, inputs longer than 64 KiB (about 2 seconds at
+    16 kHz) are decoded in slices so a whole file does not block a dirty
+    scheduler for its full duration. Decoding stops at the first utterance
+    end and returns `{:utterance_ended, rest}`, so the caller must fetch the
+    result and feed `rest` to get the remaining utterances. The recognizer
+    stays claimed between slices, so other calls on it still return
+    `{:error, :busy}`. Defaults to `false`: the whole input is decoded in
+    one call, as one utterance.
 
   ## Returns
 
   - `:utterance_ended` - Silence detected, call `result/1` to get recognition
+  - `{:utterance_ended, rest}` - Only with `split: true`: silence detected
+    partway through a long input; call `result/1`, then feed `rest` (the
+    audio not yet processed)
   - `:continue` - Keep feeding audio, can call `partial_result/1` for progress
   - `:error` - An error occurred
+  - `{:error, :busy}` - Another call is using the recognizer right now
 
   ## Examples
 
       iex> audio = File.read!("audio.raw")
       iex> VoskEx.Recognizer.accept_waveform(recognizer, audio)
       :utterance_ended
+
+      iex> VoskEx.Recognizer.accept_waveform(recognizer, f32_frame, format: :f32le)
+      :continue
+
+      iex> VoskEx.Recognizer.accept_waveform(recognizer, long_audio, split: true)
+      {:utterance_ended, rest}
   """
-  @spec accept_waveform(t(), binary()) :: waveform_result()
-  def accept_waveform(%__MODULE__{ref: ref}, audio_data) when is_binary(audio_data) do
-    case VoskEx.accept_waveform(ref, audio_data) do
-      1 -> :utterance_ended
-      0 -> :continue
-      -1 -> :error
-    end
+  @spec accept_waveform(t(), iodata(), keyword()) :: waveform_result()
+  def accept_waveform(%__MODULE__{ref: ref} = recognizer, audio_data, opts \\ [])
+      when is_binary(audio_data) or is_list(audio_data) do
+    format = sample_format(opts)
+
+    split =
+      case Keyword.get(opts, :split, false) do
+        true -> 1
+        false -> 0
+        other -> raise ArgumentError, "invalid :split option: #{inspect(other)}"
+      end
+
+    VoskEx.Telemetry.span_decode([:vosk_ex, :accept_waveform, :stop], recognizer, fn ->
+      case VoskEx.accept_waveform(ref, audio_data, format, split) do
+        1 -> :utterance_ended
+        {1, rest} -> {:utterance_ended, rest}
+        0 -> :continue
+        -1 -> :error
+        {:error, :busy} = error -> error
+      end
+    end)
+  end
+
+  @doc """
+  Process audio and return the matching result in one call.
+
+  Equivalent to `accept_waveform/3` followed by `result/2` (when the utterance
+  ended) or `partial_result/2`, but done in a single NIF call so streaming
+  loops cross into native code once per chunk.
+
+  `audio_data` is a binary or iodata, like for `accept_waveform/3`. It is
+  decoded in one native call and yields at most one result, so `feed/3` is
+  meant for streaming chunks. There is no `:split` option: a long input is
+  decoded on the dirty scheduler in one go and counts as one utterance. Use
+  `accept_waveform/3` with `split: true` for whole files.
+
+  ## Options
+
+  - `:format` - `:s16le` (default) or `:f32le`, see `accept_waveform/3`
+  - `:partial` - when `true` (default), return the partial result while the
+    utterance continues; when `false`, return `:continue` instead; when
+    `:changed`, return it only if it differs from the last one returned, as
+    `partial_result_if_changed/2` does
+  - `:decode` - `:jason` (default), `:native` or `:packed`, see `result/2`
+
+  ## Returns
+
+  - `{:utterance, map}` - the utterance ended, `map` is its final result
+  - `{:partial, map}` - the utterance continues, `map` is the partial result
+  - `:unchanged` - the utterance continues with the same partial result as
+    last time and `partial: :changed` was given
+  - `:continue` - the utterance continues and `partial: false` was given
+  - `:error` or `{:error, reason}` - processing or decoding failed
+
+  ## Examples
+
+      iex> VoskEx.Recognizer.feed(recognizer, chunk)
+      {:partial, %{"partial" => "hello wor"}}
+
+      iex> VoskEx.Recognizer.feed(recognizer, chunk, partial: false)
+      :continue
+
+      iex> VoskEx.Recognizer.feed(recognizer, chunk, partial: :changed)
+      :unchanged
+  """
+  @spec feed(t(), iodata(), keyword()) ::
+          {:utterance, recognition_result()}
+          | {:partial, recognition_result()}
+          | :unchanged
+          | :continue
+          | :error
+          | {:error, decode_error()}
+  def feed(%__MODULE__{ref: ref} = recognizer, audio_data, opts \\ [])
+      when is_binary(audio_data) or is_list(audio_data) do
+    want_partial =
+      case Keyword.get(opts, :partial, true) do
+        :changed -> 2
+        true -> 1
+        false -> 0
+        other -> raise ArgumentError, "invalid :partial option: #{inspect(other)}"
+      end
+
+    decode = decode_mode(opts)
+    format = sample_format(opts)
+
+    VoskEx.Telemetry.span_decode([:vosk_ex, :feed, :stop], recognizer, fn ->
+      case VoskEx.feed(ref, audio_data, want_partial, decode, format) do
+        {kind, json} when is_binary(json) ->
+          with {:ok, result} <- decode_json(json), do: {kind, result}
+
+        other ->
+          other
+      end
+    end)
+  end
+
+  @doc """
+  Process audio data on the native async worker pool.
+
+  Returns `:ok` right away. When the audio has been decoded the calling process
+  receives `{:vosk, ref, result}`, where `ref` is the recognizer's `:ref` and
+  `result` is one of:
+
+  - `:utterance_ended` - an endpoint was detected; fetch it with `result/2`
+  - `:continue` - more audio is needed
+  - `:error` - libvosk failed to decode the chunk
+
+  The audio is decoded in one call, as s16le mono, so unlike
+  `accept_waveform/3` there is no format option, no rest of the input and no
+  `{:error, :busy}`: a chunk waits for a concurrent call on the recognizer to
+  finish. Chunks queued on the same recognizer are decoded in order.
+
+  The pool is separate from the BEAM dirty schedulers; size it with
+  `config :vosk_ex, async_threads: n`.
+
+  Do not call other functions on the recognizer until the pending messages
+  have arrived.
+
+  ## Examples
+
+      iex> :ok = VoskEx.Recognizer.accept_waveform_async(recognizer, chunk)
+      iex> ref = recognizer.ref
+      iex> receive do
+      ...>   {:vosk, ^ref, result} -> result
+      ...> end
+      :continue
+  """
+  @spec accept_waveform_async(t(), binary()) ::
+          :ok | {:error, :thread_create_failed | :out_of_memory}
+  def accept_waveform_async(%__MODULE__{ref: ref}, audio_data) when is_binary(audio_data) do
+    VoskEx.accept_waveform_async(ref, audio_data)
+  end
+
+  @doc """
+  Return the silence gate counters for a recognizer created with `vad:`.
+
+  Counts are in 10 ms frames: `:decoded_frames` reached the acoustic model,
+  `:skipped_frames` were dropped as silence.
+
+  ## Examples
+
+      iex> VoskEx.Recognizer.vad_stats(recognizer)
+      {:ok, %{decoded_frames: 1520, skipped_frames: 4310}}
+  """
+  @spec vad_stats(t()) ::
+          {:ok, %{decoded_frames: non_neg_integer(), skipped_frames: non_neg_integer()}}
+          | {:error, :vad_disabled | :busy}
+  def vad_stats(%__MODULE__{ref: ref}) do
+    VoskEx.vad_stats(ref)
+  end
+
+  @doc """
+  Return the cumulative decoding counters of a recognizer.
+
+  - `:samples_fed` - mono samples fed, at the recognizer's sample rate
+  - `:audio_seconds` - the same as seconds of audio
+  - `:decode_ns` - native time spent decoding and fetching results
+  - `:utterances` - utterance and final results fetched
+  - `:result_bytes` - result JSON produced by libvosk
+
+  Counters are read natively without waiting for a call in progress, so this
+  is safe to poll while another process streams through the recognizer. They
+  are not cleared by `reset/1`.
+
+  ## Examples
+
+      iex> VoskEx.Recognizer.stats(recognizer)
+      %{samples_fed: 480000, audio_seconds: 30.0, decode_ns: 2310000000,
+        utterances: 6, result_bytes: 612}
+  """
+  @spec stats(t()) :: %{atom() => non_neg_integer() | float()}
+  def stats(%__MODULE__{ref: ref}) do
+    VoskEx.recognizer_stats(ref)
   end
 
   @doc """
@@ -174,67 +634,257 @@ defmodule VoskEx.Recognizer do
 
   Call this after `accept_waveform/2` returns `:utterance_ended`.
 
+  ## Options
+
+  - `:decode` - `:jason` (default) parses the JSON with Jason, `:native` decodes
+    it inside the NIF into the same map shape without an intermediate binary.
+    `:packed` decodes natively and turns word lists (`"result"`, also inside
+    `"alternatives"`, and `"partial_result"`) into `VoskEx.WordTimings`
+    structs of packed columns instead of one map per word, for long
+    recordings with `set_words/2` enabled
+
   ## Examples
 
       iex> VoskEx.Recognizer.result(recognizer)
       {:ok, %{"text" => "hello world"}}
+
+      iex> VoskEx.Recognizer.result(recognizer, decode: :native)
+      {:ok, %{"text" => "hello world"}}
+
+      iex> VoskEx.Recognizer.result(recognizer, decode: :packed)
+      {:ok, %{"text" => "hello world", "result" => %VoskEx.WordTimings{}}}
   """
-  @spec result(t()) :: {:ok, recognition_result()} | {:error, Jason.DecodeError.t()}
-  def result(%__MODULE__{ref: ref}) do
-    ref
-    |> VoskEx.get_result()
-    |> Jason.decode()
+  @spec result(t(), keyword()) :: {:ok, recognition_result()} | {:error, decode_error()}
+  def result(%__MODULE__{ref: ref} = recognizer, opts \\ []) do
+    decode = decoder(opts)
+
+    VoskEx.Telemetry.span_result(:result, decode, recognizer, fn ->
+      case decode do
+        :jason -> ref |> VoskEx.get_result() |> decode_json()
+        :native -> VoskEx.get_result_decoded(ref, 0)
+        :packed -> VoskEx.get_result_decoded(ref, 1)
+      end
+    end)
   end
 
   @doc """
   Get the current partial recognition result as a parsed map.
 
-  Can be called while recognition is in progress.
+  Can be called while recognition is in progress. Accepts the same options as
+  `result/2`.
 
   ## Examples
 
       iex> VoskEx.Recognizer.partial_result(recognizer)
       {:ok, %{"partial" => "hello wor"}}
   """
-  @spec partial_result(t()) :: {:ok, recognition_result()} | {:error, Jason.DecodeError.t()}
-  def partial_result(%__MODULE__{ref: ref}) do
-    ref
-    |> VoskEx.get_partial_result()
-    |> Jason.decode()
+  @spec partial_result(t(), keyword()) :: {:ok, recognition_result()} | {:error, decode_error()}
+  def partial_result(%__MODULE__{ref: ref} = recognizer, opts \\ []) do
+    decode = decoder(opts)
+
+    VoskEx.Telemetry.span_result(:partial, decode, recognizer, fn ->
+      case decode do
+        :jason -> ref |> VoskEx.get_partial_result() |> decode_json()
+        :native -> VoskEx.get_partial_result_decoded(ref, 0)
+        :packed -> VoskEx.get_partial_result_decoded(ref, 1)
+      end
+    end)
+  end
+
+  @doc """
+  Get the partial result only if it changed since the last call.
+
+  Most chunks of a stream leave the hypothesis as it was. The recognizer keeps
+  the last partial result this function (or `feed/3` with `partial: :changed`)
+  returned and compares inside the NIF, so an unchanged hypothesis costs no
+  JSON copy or decode and comes back as `:unchanged`. The memory is cleared
+  by `result/2`, `final_result/2` and `reset/1`, so the first partial of every
+  utterance is always returned. Accepts the same options as `result/2`.
+
+  ## Examples
+
+      iex> VoskEx.Recognizer.partial_result_if_changed(recognizer)
+      {:ok, %{"partial" => "hello wor"}}
+
+      iex> VoskEx.Recognizer.partial_result_if_changed(recognizer)
+      :unchanged
+  """
+  @spec partial_result_if_changed(t(), keyword()) ::
+          {:ok, recognition_result()} | :unchanged | {:error, decode_error()}
+  def partial_result_if_changed(%__MODULE__{ref: ref} = recognizer, opts \\ []) do
+    mode = decode_mode(opts)
+
+    VoskEx.Telemetry.span_result(:partial_if_changed, decoder(opts), recognizer, fn ->
+      case VoskEx.partial_result_if_changed(ref, mode) do
+        {:ok, json} when is_binary(json) -> decode_json(json)
+        other -> other
+      end
+    end)
   end
 
   @doc """
   Get the final result at the end of the audio stream.
 
-  This flushes the feature pipeline to process any remaining audio.
+  This flushes the feature pipeline to process any remaining audio. Accepts the
+  same options as `result/2`.
 
   ## Examples
 
       iex> VoskEx.Recognizer.final_result(recognizer)
       {:ok, %{"text" => "hello world"}}
   """
-  @spec final_result(t()) :: {:ok, recognition_result()} | {:error, Jason.DecodeError.t()}
-  def final_result(%__MODULE__{ref: ref}) do
-    ref
-    |> VoskEx.get_final_result()
-    |> Jason.decode()
+  @spec final_result(t(), keyword()) :: {:ok, recognition_result()} | {:error, decode_error()}
+  def final_result(%__MODULE__{ref: ref} = recognizer, opts \\ []) do
+    decode = decoder(opts)
+
+    VoskEx.Telemetry.span_result(:final, decode, recognizer, fn ->
+      case decode do
+        :jason -> ref |> VoskEx.get_final_result() |> decode_json()
+        :native -> VoskEx.get_final_result_decoded(ref, 0)
+        :packed -> VoskEx.get_final_result_decoded(ref, 1)
+      end
+    end)
+  end
+
+  @doc """
+  Snapshot the utterance in progress into a binary that `restore/2` can
+  resume on another recognizer, on this node or another one.
+
+  libvosk cannot serialize its decoder state, so the checkpoint holds the
+  audio fed since the last utterance result (as 16-bit samples at the
+  recognizer's rate), where it starts on the recognizer's timeline, and the
+  `set_words/2`, `set_partial_words/2` and `set_max_alternatives/2`
+  settings. Utterances whose result was already fetched are not part of it.
+  Restoring decodes the audio again, which takes a fraction of its duration.
+
+  Needs a recognizer created with the `:checkpoint` option. Returns
+  `{:error, :tail_overflow}` while the utterance in progress is longer than
+  its `:max_seconds`, and `{:error, :busy}` while another call is running.
+
+  ## Examples
+
+      iex> {:ok, checkpoint} = VoskEx.Recognizer.checkpoint(recognizer)
+      iex> {:ok, other} = VoskEx.Recognizer.new(model, 16000.0, checkpoint: true)
+      iex> VoskEx.Recognizer.restore(other, checkpoint)
+      :continue
+  """
+  @spec checkpoint(t()) ::
+          {:ok, binary()} | {:error, :checkpoints_disabled | :tail_overflow | :busy}
+  def checkpoint(%__MODULE__{ref: ref}) do
+    with {:ok, state} <- VoskEx.checkpoint(ref) do
+      {:ok,
+       <<"VXCK", @checkpoint_version, state.sample_rate::float-little-64,
+         state.start::little-64, state.words, state.partial_words,
+         state.max_alternatives::little-16, state.audio::binary>>}
+    end
+  end
+
+  @doc """
+  Resume an utterance from a `checkpoint/1` binary.
+
+  The recognizer must be created with the same sample rate, model and
+  creation options (`:grammar`, `:speaker_model`, `:vad`, input format) as
+  the one the checkpoint came from, and have no utterance in progress: a new
+  recognizer, one that was `reset/1`, or one whose last result was fetched.
+  The checkpoint's result settings are applied to it. Word `"start"` and
+  `"end"` times in later results continue the original recognizer's
+  timeline, so a stream moved to another node reports the same times.
+
+  Pass `:checkpoint` when creating the recognizer to be able to move the
+  utterance again.
+
+  ## Returns
+
+  - `:continue` - keep feeding audio, as after `accept_waveform/2`
+  - `:utterance_ended` - the replayed audio ended the utterance; call `result/1`
+  - `:error` - libvosk failed to decode the audio
+  - `{:error, :invalid_checkpoint}` - not a checkpoint binary
+  - `{:error, :sample_rate_mismatch}` - the recognizer runs at another rate
+  - `{:error, :not_idle}` - audio of an unfinished utterance was fed already
+  - `{:error, :busy}` - another call is using the recognizer right now
+  """
+  @spec restore(t(), binary()) ::
+          :continue
+          | :utterance_ended
+          | :error
+          | {:error, :invalid_checkpoint | :sample_rate_mismatch | :not_idle | :busy}
+  def restore(%__MODULE__{ref: ref} = recognizer, checkpoint) when is_binary(checkpoint) do
+    case checkpoint do
+      <<"VXCK", @checkpoint_version, sample_rate::float-little-64, start::little-64, words,
+        partial_words, max_alternatives::little-16, audio::binary>>
+      when rem(byte_size(audio), 2) == 0 ->
+        with :ok <- set_words(recognizer, words == 1),
+             :ok <- set_partial_words(recognizer, partial_words == 1),
+             :ok <- set_max_alternatives(recognizer, max_alternatives) do
+          VoskEx.Telemetry.span_decode([:vosk_ex, :restore, :stop], recognizer, fn ->
+            case VoskEx.restore_checkpoint(ref, sample_rate, audio, start) do
+              1 -> :utterance_ended
+              0 -> :continue
+              -1 -> :error
+              {:error, _} = error -> error
+            end
+          end)
+        end
+
+      _ ->
+        {:error, :invalid_checkpoint}
+    end
   end
 
   @doc """
   Reset the recognizer to start fresh.
 
-  Clears all current recognition state.
+  Clears all current recognition state. A recognizer restored from a
+  checkpoint stops shifting word times onto the original timeline, so a
+  pooled recognizer does not carry the offset over to its next user.
 
   ## Examples
 
       iex> VoskEx.Recognizer.reset(recognizer)
       :ok
   """
-  @spec reset(t()) :: :ok
+  @spec reset(t()) :: :ok | {:error, :busy}
   def reset(%__MODULE__{ref: ref}) do
     VoskEx.reset_recognizer(ref)
   end
 
+  defp decode_json(json) when is_binary(json) do
+    with {:ok, result} <- Jason.decode(json), do: {:ok, pack_speaker_vector(result)}
+  end
+
+  defp decode_json({:error, _} = error), do: error
+
+  # The native decoder packs "spk" itself; do the same for Jason output
+  defp pack_speaker_vector(%{"spk" => vector} = result) when is_list(vector) do
+    %{result | "spk" => for(x <- vector, into: <<>>, do: <<x::float-32-native>>)}
+  end
+
+  defp pack_speaker_vector(result), do: result
+
+  defp sample_format(opts) do
+    case Keyword.get(opts, :format, :s16le) do
+      :s16le -> 0
+      :f32le -> 1
+      other -> raise ArgumentError, "invalid :format option: #{inspect(other)}"
+    end
+  end
+
+  # Decode argument of the feed and partial_result_if_changed NIFs
+  defp decode_mode(opts) do
+    case decoder(opts) do
+      :jason -> 0
+      :native -> 1
+      :packed -> 2
+    end
+  end
+
+  defp decoder(opts) do
+    case Keyword.get(opts, :decode, :jason) do
+      decoder when decoder in [:jason, :native, :packed] -> decoder
+      other -> raise ArgumentError, "invalid :decode option: #{inspect(other)}"
+    end
+  end
+
   defimpl Inspect do
     def inspect(%{ref: _}, _opts), do: "#VoskEx.Recognizer<...>"
   end
@@ -0,0 +1,285 @@
+defmodule VoskEx.RecognizerPool do
+  @moduledoc """
+  Pools of ready-to-use recognizers, keyed by model, sample rate and options.
+
+  Creating a recognizer allocates decoder state inside libvosk, which is
+  wasteful for workloads made of many short calls. A pool keeps recognizers
+  around between calls: checking one out hands over an already configured
+  recognizer, checking it back in resets it so the next caller starts fresh.
+
+  Pools are started on demand under the `VoskEx` application supervisor. Each
+  distinct `{model, sample_rate, recognizer options}` combination gets its own
+  pool, so `get/3` with the same arguments always returns the same pool.
+
+  ## Example
+
+  ```elixir
+  {:ok, model} = VoskEx.Model.load("models/vosk-model-small-en-us-0.15")
+  {:ok, pool} = VoskEx.RecognizerPool.get(model, 16000.0, words: true, min: 4, max: 64)
+
+  VoskEx.RecognizerPool.transaction(pool, fn rec ->
+    VoskEx.Recognizer.accept_waveform(rec, audio)
+    VoskEx.Recognizer.final_result(rec)
+  end)
+  ```
+
+  ## Options
+
+  Recognizer options (part of the pool key):
+
+  - `:words` - enable word timings in results (see `VoskEx.Recognizer.set_words/2`)
+  - `:partial_words` - enable word timings in partial results
+  - `:max_alternatives` - number of alternatives to return
+  - `:grammar` - phrase list the recognizers are restricted to (see
+    `VoskEx.Recognizer.set_grammar/2`). The pool is keyed by a hash of the
+    list, so every call using the same menu shares recognizers whose grammar
+    was compiled once, instead of compiling it again per call.
+  - `:speaker_model` - a `VoskEx.SpkModel` for speaker vectors in results
+  - `:endpointer` - endpointing rules (see `VoskEx.Recognizer.set_endpointer/2`)
+
+  Pool options (only used when the pool is first started):
+
+  - `:min` - recognizers created up front and kept when idle (default: `1`)
+  - `:max` - upper bound on recognizers; further checkouts wait (default: `16`)
+  - `:idle_timeout` - milliseconds an idle recognizer above `:min` is kept
+    before it is freed (default: `30_000`). A pool with nothing checked out
+    for this long stops, freeing its `:min` recognizers too.
+
+  ## Lifetime
+
+  A pool keeps its model loaded while it runs. So that an unused model can be
+  freed (see `VoskEx.Model`), a pool stops once `:idle_timeout` passes with
+  no checkout or checkin and nothing checked out. The next `get/3` with the
+  same arguments starts a new one, creating `:min` recognizers again. Call
+  `get/3` per unit of work instead of keeping the pid: calls on a stopped
+  pool return `{:error, :pool_stopped}`.
+
+  ## Ownership
+
+  A checked out recognizer belongs to the calling process. If that process
+  exits without checking it in, the pool resets and reclaims it.
+
+  ## Telemetry
+
+  See `VoskEx.Telemetry` for recognizer and model events.
+
+  - `[:vosk_ex, :recognizer_pool, :checkout]` - emitted after every checkout.
+    Measurements: `:wait_time` (native time units). Metadata: `:pool`,
+    `:sample_rate`, `:result` (`:ok` or the error reason, e.g. `:timeout`).
+  - `[:vosk_ex, :recognizer_pool, :saturated]` - emitted when a checkout has
+    to wait because all `:max` recognizers are in use. Measurements: `:size`,
+    `:waiting`. Metadata: `:pool`, `:sample_rate`.
+  """
+
+  use Supervisor
+
+  alias VoskEx.RecognizerPool.Pool
+
+  @registry VoskEx.RecognizerPool.Registry
+  @pool_supervisor VoskEx.RecognizerPool.PoolSupervisor
+
+  @recognizer_option_keys [
+    :words,
+    :partial_words,
+    :max_alternatives,
+    :grammar,
+    :speaker_model,
+    :endpointer
+  ]
+
+  @type pool :: pid()
+
+  @doc false
+  def start_link(opts) do
+    Supervisor.start_link(__MODULE__, opts, name: __MODULE__)
+  end
+
+  @impl true
+  def init(_opts) do
+    children = [
+      {Registry, keys: :unique, name: @registry},
+      {DynamicSupervisor, strategy: :one_for_one, name: @pool_supervisor}
+    ]
+
+    Supervisor.init(children, strategy: :one_for_all)
+  end
+
+  @doc """
+  Get the pool for a model, sample rate and recognizer options, starting it if needed.
+
+  ## Examples
+
+      iex> {:ok, pool} = VoskEx.RecognizerPool.get(model, 16000.0, words: true)
+      iex> is_pid(pool)
+      true
+  """
+  @spec get(VoskEx.Model.t(), number(), keyword()) :: {:ok, pool()} | {:error, term()}
+  def get(%VoskEx.Model{ref: model_ref} = model, sample_rate, opts \\ [])
+      when is_number(sample_rate) do
+    {recognizer_opts, pool_opts} = Keyword.split(opts, @recognizer_option_keys)
+    recognizer_opts = Enum.sort(recognizer_opts)
+    key = {model_ref, sample_rate / 1.0, Enum.map(recognizer_opts, &key_option/1)}
+
+    case Registry.lookup(@registry, key) do
+      [{pid, _}] ->
+        {:ok, pid}
+
+      [] ->
+        spec =
+          {Pool,
+           key: key,
+           name: {:via, Registry, {@registry, key}},
+           model: model,
+           sample_rate: sample_rate / 1.0,
+           recognizer_opts: recognizer_opts,
+           pool_opts: pool_opts}
+
+        case DynamicSupervisor.start_child(@pool_supervisor, spec) do
+          {:ok, pid} -> {:ok, pid}
+          {:error, {:already_started, pid}} -> {:ok, pid}
+          error -> error
+        end
+    end
+  end
+
+  @doc """
+  Check out a recognizer, waiting up to `timeout` milliseconds if the pool is saturated.
+
+  ## Examples
+
+      iex> {:ok, rec} = VoskEx.RecognizerPool.checkout(pool)
+      iex> VoskEx.RecognizerPool.checkin(pool, rec)
+      :ok
+  """
+  @spec checkout(pool(), timeout()) ::
+          {:ok, VoskEx.Recognizer.t()}
+          | {:error, :timeout | :recognizer_creation_failed | :pool_stopped}
+  def checkout(pool, timeout \\ 5000) do
+    started = System.monotonic_time()
+
+    {reply, sample_rate} =
+      case call_pool(pool, {:checkout, timeout}, :infinity) do
+        {:ok, recognizer, sample_rate} ->
+          {{:ok, recognizer}, sample_rate}
+
+        {:create, {model, sample_rate, recognizer_opts}} ->
+          {create(pool, model, sample_rate, recognizer_opts), sample_rate}
+
+        {:error, reason, sample_rate} ->
+          {{:error, reason}, sample_rate}
+
+        {:error, :pool_stopped} ->
+          {{:error, :pool_stopped}, nil}
+      end
+
+    :telemetry.execute(
+      [:vosk_ex, :recognizer_pool, :checkout],
+      %{wait_time: System.monotonic_time() - started},
+      %{pool: pool, sample_rate: sample_rate, result: result_tag(reply)}
+    )
+
+    reply
+  end
+
+  @doc """
+  Return a recognizer to its pool.
+
+  The recognizer is reset before it is handed to the next caller. Returns
+  `{:error, :busy}`, leaving it checked out, if a call on it is still running.
+  """
+  @spec checkin(pool(), VoskEx.Recognizer.t()) :: :ok | {:error, :busy}
+  def checkin(pool, %VoskEx.Recognizer{} = recognizer) do
+    with :ok <- VoskEx.Recognizer.reset(recognizer) do
+      GenServer.cast(pool, {:checkin, recognizer})
+    end
+  end
+
+  @doc """
+  Check out a recognizer, run `fun` with it and check it back in.
+
+  Returns `{:ok, fun_result}` or `{:error, reason}` if no recognizer could be checked out.
+  """
+  @spec transaction(pool(), (VoskEx.Recognizer.t() -> result), timeout()) ::
+          {:ok, result} | {:error, :timeout | :recognizer_creation_failed | :pool_stopped}
+        when result: any()
+  def transaction(pool, fun, timeout \\ 5000) when is_function(fun, 1) do
+    with {:ok, recognizer} <- checkout(pool, timeout) do
+      try do
+        {:ok, fun.(recognizer)}
+      after
+        checkin(pool, recognizer)
+      end
+    end
+  end
+
+  @doc """
+  Return the current size and usage of a pool.
+
+  ## Examples
+
+      iex> VoskEx.RecognizerPool.status(pool)
+      %{size: 4, idle: 3, in_use: 1, waiting: 0, min: 1, max: 16}
+  """
+  @spec status(pool()) :: %{atom() => non_neg_integer()} | {:error, :pool_stopped}
+  def status(pool) do
+    call_pool(pool, :status, 5000)
+  end
+
+  # A pool stops after :idle_timeout unused (see "Lifetime"), so a kept pid
+  # can outlive it
+  defp call_pool(pool, request, timeout) do
+    GenServer.call(pool, request, timeout)
+  catch
+    :exit, {reason, _} when reason in [:noproc, :normal] -> {:error, :pool_stopped}
+  end
+
+  # Pids of the pools running on this node, for VoskEx.Cluster load reports
+  @doc false
+  def pools do
+    Registry.select(@registry, [{{:_, :"$1", :_}, [], [:"$1"]}])
+  end
+
+  # The pool reserved a slot for us; build the recognizer in the caller so a
+  # burst of checkouts does not serialize recognizer creation in the pool.
+  defp create(pool, model, sample_rate, recognizer_opts) do
+    case new_recognizer(model, sample_rate, recognizer_opts) do
+      {:ok, recognizer} ->
+        GenServer.cast(pool, {:created, self(), recognizer})
+        {:ok, recognizer}
+
+      {:error, reason} ->
+        GenServer.cast(pool, {:create_failed, self()})
+        {:error, reason}
+    end
+  end
+
+  # Phrase lists can be long, so the registry key holds a digest instead
+  defp key_option({:grammar, phrases}),
+    do: {:grammar, :erlang.md5(:erlang.term_to_binary(phrases))}
+
+  defp key_option(option), do: option
+
+  @doc false
+  def new_recognizer(model, sample_rate, recognizer_opts) do
+    create_opts = Keyword.take(recognizer_opts, [:grammar, :speaker_model, :endpointer])
+
+    with {:ok, recognizer} <- VoskEx.Recognizer.new(model, sample_rate, create_opts) do
+      configure(recognizer, recognizer_opts)
+      {:ok, recognizer}
+    end
+  end
+
+  defp configure(recognizer, recognizer_opts) do
+    Enum.each(recognizer_opts, fn
+      {:grammar, _phrases} -> :ok
+      {:speaker_model, _spk_model} -> :ok
+      {:endpointer, _ep_opts} -> :ok
+      {:words, enabled} -> VoskEx.Recognizer.set_words(recognizer, enabled)
+      {:partial_words, enabled} -> VoskEx.Recognizer.set_partial_words(recognizer, enabled)
+      {:max_alternatives, max} -> VoskEx.Recognizer.set_max_alternatives(recognizer, max)
+    end)
+  end
+
+  defp result_tag({:ok, _}), do: :ok
+  defp result_tag({:error, reason}), do: reason
+end
@@ -0,0 +1,279 @@
+defmodule VoskEx.RecognizerPool.Pool do
+  # A single recognizer pool for one {model, sample_rate, options} key.
+  # See VoskEx.RecognizerPool for the public API.
+  @moduledoc false
+
+  use GenServer
+
+  @default_min 1
+  @default_max 16
+  @default_idle_timeout 30_000
+
+  def child_spec(opts) do
+    %{
+      id: Keyword.fetch!(opts, :key),
+      start: {__MODULE__, :start_link, [opts]},
+      # An unused pool stops normally and is started again by the next get/3
+      restart: :transient
+    }
+  end
+
+  def start_link(opts) do
+    GenServer.start_link(__MODULE__, opts, name: Keyword.fetch!(opts, :name))
+  end
+
+  @impl true
+  def init(opts) do
+    pool_opts = Keyword.fetch!(opts, :pool_opts)
+    min = Keyword.get(pool_opts, :min, @default_min)
+    max = Keyword.get(pool_opts, :max, @default_max)
+
+    if min < 0 or max < 1 or min > max do
+      {:stop, {:invalid_pool_bounds, min, max}}
+    else
+      state = %{
+        model: Keyword.fetch!(opts, :model),
+        sample_rate: Keyword.fetch!(opts, :sample_rate),
+        recognizer_opts: Keyword.fetch!(opts, :recognizer_opts),
+        min: min,
+        max: max,
+        idle_timeout: Keyword.get(pool_opts, :idle_timeout, @default_idle_timeout),
+        # Idle recognizers as {recognizer, idle_since} with the most recent first
+        idle: [],
+        # Checked out recognizers by monitor ref: {pid, recognizer | :pending}
+        checkouts: %{},
+        # Callers waiting for a recognizer: {from, monitor_ref, timer_ref}
+        waiting: :queue.new(),
+        size: 0,
+        # Last checkout or checkin; the pool stops once idle_timeout passes
+        # without either, so it no longer holds the model
+        last_used: System.monotonic_time(:millisecond)
+      }
+
+      {:ok, state, {:continue, :prefill}}
+    end
+  end
+
+  @impl true
+  def handle_continue(:prefill, state) do
+    state = Enum.reduce(1..state.min//1, state, fn _, acc -> add_idle(acc) end)
+    schedule_shrink(state)
+    {:noreply, state}
+  end
+
+  @impl true
+  def handle_call({:checkout, timeout}, {pid, _} = from, state) do
+    state = touch(state)
+
+    case state.idle do
+      [{recognizer, _} | rest] ->
+        ref = Process.monitor(pid)
+        checkouts = Map.put(state.checkouts, ref, {pid, recognizer})
+        state = %{state | idle: rest, checkouts: checkouts}
+        {:reply, {:ok, recognizer, state.sample_rate}, state}
+
+      [] when state.size < state.max ->
+        ref = Process.monitor(pid)
+        checkouts = Map.put(state.checkouts, ref, {pid, :pending})
+        config = {state.model, state.sample_rate, state.recognizer_opts}
+        {:reply, {:create, config}, %{state | size: state.size + 1, checkouts: checkouts}}
+
+      [] ->
+        ref = Process.monitor(pid)
+        waiting = :queue.in({from, ref, start_timer(ref, timeout)}, state.waiting)
+
+        :telemetry.execute(
+          [:vosk_ex, :recognizer_pool, :saturated],
+          %{size: state.size, waiting: :queue.len(waiting)},
+          %{pool: self(), sample_rate: state.sample_rate}
+        )
+
+        {:noreply, %{state | waiting: waiting}}
+    end
+  end
+
+  def handle_call(:status, _from, state) do
+    status = %{
+      size: state.size,
+      idle: length(state.idle),
+      in_use: map_size(state.checkouts),
+      waiting: :queue.len(state.waiting),
+      min: state.min,
+      max: state.max
+    }
+
+    {:reply, status, state}
+  end
+
+  @impl true
+  def handle_cast({:checkin, %VoskEx.Recognizer{ref: rec_ref} = recognizer}, state) do
+    case Enum.find(state.checkouts, fn {_, {_, rec}} -> match?(%{ref: ^rec_ref}, rec) end) do
+      {ref, _} ->
+        Process.demonitor(ref, [:flush])
+        state = %{touch(state) | checkouts: Map.delete(state.checkouts, ref)}
+        {:noreply, release(state, recognizer)}
+
+      nil ->
+        {:noreply, state}
+    end
+  end
+
+  def handle_cast({:created, pid, recognizer}, state) do
+    case find_pending(state, pid) do
+      {ref, _} -> {:noreply, put_in(state.checkouts[ref], {pid, recognizer})}
+      nil -> {:noreply, state}
+    end
+  end
+
+  def handle_cast({:create_failed, pid}, state) do
+    case find_pending(state, pid) do
+      {ref, _} ->
+        Process.demonitor(ref, [:flush])
+        state = %{state | checkouts: Map.delete(state.checkouts, ref), size: state.size - 1}
+        {:noreply, serve_waiting_by_growing(state)}
+
+      nil ->
+        {:noreply, state}
+    end
+  end
+
+  @impl true
+  def handle_info({:DOWN, ref, :process, _pid, _reason}, state) do
+    case Map.pop(state.checkouts, ref) do
+      {{_pid, :pending}, checkouts} ->
+        # Died while creating its recognizer; the slot is free again
+        state = %{state | checkouts: checkouts, size: state.size - 1}
+        {:noreply, serve_waiting_by_growing(state)}
+
+      {{_pid, recognizer}, checkouts} ->
+        # The owner is gone; reuse the recognizer unless someone else it was
+        # shared with is still running a call on it
+        state = %{state | checkouts: checkouts}
+
+        case VoskEx.Recognizer.reset(recognizer) do
+          :ok -> {:noreply, release(state, recognizer)}
+          {:error, :busy} -> {:noreply, serve_waiting_by_growing(%{state | size: state.size - 1})}
+        end
+
+      {nil, _} ->
+        {:noreply, drop_waiting(state, ref)}
+    end
+  end
+
+  def handle_info({:timeout, ref}, state) do
+    case take_waiting(state.waiting, ref) do
+      {{from, ^ref, _timer}, waiting} ->
+        Process.demonitor(ref, [:flush])
+        GenServer.reply(from, {:error, :timeout, state.sample_rate})
+        {:noreply, %{state | waiting: waiting}}
+
+      nil ->
+        {:noreply, state}
+    end
+  end
+
+  def handle_info(:shrink, state) do
+    now = System.monotonic_time(:millisecond)
+    excess = max(state.size - state.min, 0)
+
+    # Idle list is newest first, so the longest idle recognizers are at the tail
+    {fresh, stale} =
+      Enum.split_while(state.idle, fn {_, since} -> now - since < state.idle_timeout end)
+
+    {kept, dropped} = Enum.split(stale, max(length(stale) - excess, 0))
+
+    state = %{state | idle: fresh ++ kept, size: state.size - length(dropped)}
+
+    if unused?(state, now) do
+      # Stopping drops the idle recognizers and the model handle, so an
+      # unloaded model can be freed; the next get/3 starts a new pool
+      {:stop, :normal, state}
+    else
+      schedule_shrink(state)
+      {:noreply, state}
+    end
+  end
+
+  defp unused?(state, now) do
+    map_size(state.checkouts) == 0 and :queue.is_empty(state.waiting) and
+      now - state.last_used >= state.idle_timeout
+  end
+
+  defp touch(state), do: %{state | last_used: System.monotonic_time(:millisecond)}
+
+  # Hand a returned recognizer to the first waiter, or park it as idle
+  defp release(state, recognizer) do
+    case :queue.out(state.waiting) do
+      {{:value, {{pid, _} = from, ref, timer}}, waiting} ->
+        cancel_timer(timer)
+        GenServer.reply(from, {:ok, recognizer, state.sample_rate})
+        checkouts = Map.put(state.checkouts, ref, {pid, recognizer})
+        %{state | waiting: waiting, checkouts: checkouts}
+
+      {:empty, _} ->
+        idle = [{recognizer, System.monotonic_time(:millisecond)} | state.idle]
+        %{state | idle: idle}
+    end
+  end
+
+  # A slot was freed without a recognizer coming back; let a waiter create one
+  defp serve_waiting_by_growing(state) do
+    case :queue.out(state.waiting) do
+      {{:value, {{pid, _} = from, ref, timer}}, waiting} when state.size < state.max ->
+        cancel_timer(timer)
+        GenServer.reply(from, {:create, {state.model, state.sample_rate, state.recognizer_opts}})
+        checkouts = Map.put(state.checkouts, ref, {pid, :pending})
+        %{state | waiting: waiting, checkouts: checkouts, size: state.size + 1}
+
+      _ ->
+        state
+    end
+  end
+
+  defp add_idle(state) do
+    recognizer_opts = state.recognizer_opts
+
+    case VoskEx.RecognizerPool.new_recognizer(state.model, state.sample_rate, recognizer_opts) do
+      {:ok, recognizer} ->
+        idle = [{recognizer, System.monotonic_time(:millisecond)} | state.idle]
+        %{state | idle: idle, size: state.size + 1}
+
+      {:error, _} ->
+        state
+    end
+  end
+
+  defp find_pending(state, pid) do
+    Enum.find(state.checkouts, fn {_, entry} -> entry == {pid, :pending} end)
+  end
+
+  defp drop_waiting(state, ref) do
+    case take_waiting(state.waiting, ref) do
+      {{_from, ^ref, timer}, waiting} ->
+        cancel_timer(timer)
+        %{state | waiting: waiting}
+
+      nil ->
+        state
+    end
+  end
+
+  defp take_waiting(waiting, ref) do
+    {match, rest} = waiting |> :queue.to_list() |> Enum.split_with(&match?({_, ^ref, _}, &1))
+
+    case match do
+      [entry] -> {entry, :queue.from_list(rest)}
+      [] -> nil
+    end
+  end
+
+  defp start_timer(_ref, :infinity), do: nil
+  defp start_timer(ref, timeout), do: Process.send_after(self(), {:timeout, ref}, timeout)
+
+  defp cancel_timer(nil), do: :ok
+  defp cancel_timer(timer), do: Process.cancel_timer(timer, info: false)
+
+  defp schedule_shrink(state) do
+    Process.send_after(self(), :shrink, state.idle_timeout)
+  end
+end
@@ -0,0 +1,90 @@
+defmodule VoskEx.SpkModel do
+  @moduledoc """
+  Speaker identification model.
+
+  A speaker model (for example `vosk-model-spk-0.4` from
+  [Vosk Models](https://alphacephei.com/vosk/models)) extracts an x-vector
+  for every utterance. Load it once and pass it to any number of recognizers
+  with the `:speaker_model` option of `VoskEx.Recognizer.new/3`; libvosk
+  reference-counts it, so it can be shared across processes.
+
+  Final results of such recognizers carry two extra keys:
+
+  - `"spk"` - the speaker vector, as a binary of native-endian 32-bit floats
+    (128 of them for `vosk-model-spk-0.4`), ready for bulk distance math
+  - `"spk_frames"` - number of frames the vector was computed from; vectors
+    from very short utterances are unreliable
+
+  ## Example
+
+  ```elixir
+  {:ok, model} = VoskEx.Model.load("models/vosk-model-small-en-us-0.15")
+  {:ok, spk} = VoskEx.SpkModel.load("models/vosk-model-spk-0.4")
+  {:ok, rec} = VoskEx.Recognizer.new(model, 16000.0, speaker_model: spk)
+
+  VoskEx.Recognizer.accept_waveform(rec, audio)
+  {:ok, %{"spk" => vector}} = VoskEx.Recognizer.final_result(rec)
+  VoskEx.SpkModel.cosine_similarity(vector, enrolled)
+  ```
+  """
+
+  @enforce_keys [:ref]
+  defstruct [:ref]
+
+  @type t :: %__MODULE__{ref: reference()}
+
+  @doc """
+  Load a speaker model from a directory path.
+
+  Loading runs on a dirty IO scheduler.
+
+  ## Examples
+
+      iex> VoskEx.SpkModel.load("path/to/vosk-model-spk-0.4")
+      {:ok, %VoskEx.SpkModel{}}
+
+      iex> VoskEx.SpkModel.load("invalid/path")
+      {:error, :spk_model_load_failed}
+  """
+  @spec load(String.t()) :: {:ok, t()} | {:error, :spk_model_load_failed}
+  def load(path) when is_binary(path) do
+    case VoskEx.load_spk_model(path) do
+      {:ok, ref} -> {:ok, %__MODULE__{ref: ref}}
+      error -> error
+    end
+  end
+
+  @doc """
+  Load a speaker model, raising on error.
+  """
+  @spec load!(String.t()) :: t()
+  def load!(path) do
+    case load(path) do
+      {:ok, model} -> model
+      {:error, reason} -> raise "Failed to load speaker model: #{reason}"
+    end
+  end
+
+  @doc """
+  Cosine similarity of two packed speaker vectors, between `-1.0` and `1.0`.
+
+  ## Examples
+
+      iex> VoskEx.SpkModel.cosine_similarity(vector, vector)
+      1.0
+  """
+  @spec cosine_similarity(binary(), binary()) :: float()
+  def cosine_similarity(a, b) when is_binary(a) and byte_size(a) == byte_size(b) do
+    {dot, norm_a, norm_b} = dot_norms(a, b, 0.0, 0.0, 0.0)
+    dot / :math.sqrt(norm_a * norm_b)
+  end
+
+  defp dot_norms(<<x::float-32-native, a::binary>>, <<y::float-32-native, b::binary>>, d, na, nb),
+    do: dot_norms(a, b, d + x * y, na + x * x, nb + y * y)
+
+  defp dot_norms(<<>>, <<>>, d, na, nb), do: {d, na, nb}
+
+  defimpl Inspect do
+    def inspect(%{ref: _}, _opts), do: "#VoskEx.SpkModel<...>"
+  end
+end
@@ -0,0 +1,498 @@
+defmodule VoskEx.Stream do
+  @moduledoc """
+  A process that owns one recognizer and decodes a stream of audio with
+  flow control, pushing results to subscribers.
+
+  Hand-written accept/poll/flush loops tend to let audio pile up in a
+  mailbox when decoding falls behind. A stream keeps the backlog in a bounded
+  queue instead and tells producers when to slow down. When several chunks
+  are waiting it decodes them together in one `VoskEx.Recognizer.feed/3` call,
+  so a stream that falls behind catches up with fewer, larger native calls.
+
+  Streams started with `start/1` run under the `VoskEx` application
+  supervisor. They are not restarted: a crashed stream has lost its decoder
+  state, so its owner should start a new one.
+
+  ## Moving a stream
+
+  A stream whose recognizer keeps checkpoints (`recognizer_opts:
+  [checkpoint: true]`) can hand its utterance in progress to a stream on
+  another node, for example when draining a node for a deploy. Stop
+  writing, take a `checkpoint/1`, and start the new stream with it:
+
+  ```elixir
+  {:ok, checkpoint} = VoskEx.Stream.checkpoint(old)
+  VoskEx.Stream.stop(old)
+
+  {:ok, new} =
+    VoskEx.Cluster.start_stream("vosk-model-en-us-0.22",
+      sample_rate: 16000.0,
+      recognizer_opts: [checkpoint: true],
+      restore: checkpoint,
+      subscribers: [self()])
+  ```
+
+  ## Example
+
+  ```elixir
+  {:ok, stream} = VoskEx.Stream.start(model: model, sample_rate: 16000.0, words: true)
+  :ok = VoskEx.Stream.subscribe(stream)
+
+  # Blocks while more than :max_queue_bytes are waiting to be decoded
+  :ok = VoskEx.Stream.write(stream, chunk)
+
+  receive do
+    {:vosk_stream, ^stream, {:utterance, result}} -> result["text"]
+  end
+
+  {:ok, final} = VoskEx.Stream.flush(stream)
+  ```
+
+  ## Flow control
+
+  There are two ways to send audio:
+
+  - `write/3` returns once the audio is queued. While the queue holds more
+    than `:max_queue_bytes`, the reply is held back until decoding catches
+    up, so a producer can never be more than one chunk ahead of the limit.
+  - `push/2` never blocks, for producers such as socket processes that must
+    keep reading. Once the audio has been decoded, the stream sends the
+    pushing process `{:vosk_stream, stream, {:ack, bytes}}`. A producer
+    keeps at most a window of unacknowledged bytes in flight, and drops or
+    buffers audio itself when the window is full. This is a credit protocol
+    where acks return credit.
+
+  ## Messages
+
+  Subscribers receive `{:vosk_stream, stream, event}`, where `event` is:
+
+  - `{:partial, result}` - the utterance continues; only sent when the
+    partial changed (unless `partial: true` is given)
+  - `{:utterance, result}` - an utterance ended
+  - `{:final, result}` - `flush/2` ended the stream's current utterance
+  - `{:error, reason}` - decoding a batch failed; the batch is dropped
+  """
+
+  use GenServer, restart: :temporary
+
+  @supervisor VoskEx.StreamSupervisor
+
+  @default_max_queue_bytes 320_000
+  @default_max_batch_bytes 32_000
+  # Retry delay when the recognizer is in use by a call outside the stream
+  @busy_retry_ms 5
+
+  @type t :: pid()
+
+  @type event ::
+          {:partial, VoskEx.Recognizer.recognition_result()}
+          | {:utterance, VoskEx.Recognizer.recognition_result()}
+          | {:final, VoskEx.Recognizer.recognition_result()}
+          | {:error, term()}
+
+  @doc """
+  Start a stream under the `VoskEx` application supervisor.
+
+  ## Options
+
+  - `:model` and `:sample_rate` - create a recognizer for the stream
+  - `:recognizer_opts` - options for `VoskEx.Recognizer.new/3`, such as
+    `:input_rate`, `:channels`, `:vad` or `:grammar`
+  - `:recognizer` - use this recognizer instead; nothing else should call it
+    while the stream runs
+  - `:words`, `:partial_words`, `:max_alternatives` - recognizer settings,
+    see `VoskEx.Recognizer.set_words/2` and friends
+  - `:subscribers` - pids to send results to (default: `[]`)
+  - `:partial` - `:changed` (default) sends partials only when they change,
+    `true` sends one per decoded batch, `false` sends none
+  - `:decode` - `:jason` (default), `:native` or `:packed`, see
+    `VoskEx.Recognizer.result/2`
+  - `:max_queue_bytes` - queued audio above which `write/3` blocks
+    (default: `320_000`, 10 seconds of 16 kHz 16-bit mono)
+  - `:max_batch_bytes` - upper bound on audio coalesced into one call
+    (default: `32_000`, 1 second of 16 kHz 16-bit mono). Larger batches mean
+    fewer native calls, but utterance ends are only noticed between batches.
+  - `:restore` - a `checkpoint/1` binary to resume before taking audio, see
+    `VoskEx.Recognizer.restore/2`. Start fails with its error if it cannot
+    be restored.
+  """
+  @spec start(keyword()) :: DynamicSupervisor.on_start_child()
+  def start(opts) do
+    DynamicSupervisor.start_child(@supervisor, {__MODULE__, opts})
+  end
+
+  @doc """
+  Start a stream linked to the caller, for use in your own supervision tree.
+
+  Takes the options of `start/1`, plus `:name`.
+  """
+  @spec start_link(keyword()) :: GenServer.on_start()
+  def start_link(opts) do
+    {gen_opts, opts} = Keyword.split(opts, [:name])
+    GenServer.start_link(__MODULE__, opts, gen_opts)
+  end
+
+  @doc """
+  Queue audio, waiting while the stream is over its queue limit.
+
+  Returns `:ok` once the audio is queued. Exits if it is not queued within
+  `timeout` milliseconds, like `GenServer.call/3`.
+  """
+  @spec write(t(), iodata(), timeout()) :: :ok
+  def write(stream, audio, timeout \\ 5000) do
+    GenServer.call(stream, {:write, audio}, timeout)
+  end
+
+  @doc """
+  Queue audio without waiting.
+
+  The caller receives `{:vosk_stream, stream, {:ack, bytes}}` once the audio
+  has been decoded; see "Flow control" above.
+  """
+  @spec push(t(), iodata()) :: :ok
+  def push(stream, audio) do
+    GenServer.cast(stream, {:push, self(), audio})
+  end
+
+  @doc """
+  Decode all queued audio and return the final result of the current utterance.
+
+  The result is also sent to subscribers as `{:final, result}`. The stream
+  keeps running and starts a new utterance with the next audio.
+  """
+  @spec flush(t(), timeout()) ::
+          {:ok, VoskEx.Recognizer.recognition_result()} | {:error, term()}
+  def flush(stream, timeout \\ 30_000) do
+    GenServer.call(stream, :flush, timeout)
+  end
+
+  @doc """
+  Decode all queued audio and snapshot the utterance in progress.
+
+  See `VoskEx.Recognizer.checkpoint/1`. Results of utterances that end while
+  the queue is decoded are sent to subscribers first, so they are not part
+  of the checkpoint. Audio written after the call is not either.
+  """
+  @spec checkpoint(t(), timeout()) :: {:ok, binary()} | {:error, term()}
+  def checkpoint(stream, timeout \\ 30_000) do
+    GenServer.call(stream, :checkpoint, timeout)
+  end
+
+  @doc """
+  Send results to `pid` (default: the caller) until it exits or unsubscribes.
+  """
+  @spec subscribe(t(), pid()) :: :ok
+  def subscribe(stream, pid \\ self()) do
+    GenServer.call(stream, {:subscribe, pid})
+  end
+
+  @doc """
+  Stop sending results to `pid`.
+  """
+  @spec unsubscribe(t(), pid()) :: :ok
+  def unsubscribe(stream, pid \\ self()) do
+    GenServer.call(stream, {:unsubscribe, pid})
+  end
+
+  @doc """
+  Return queue and decoding counters of a stream.
+
+  ## Examples
+
+      iex> VoskEx.Stream.status(stream)
+      %{queued_bytes: 6400, queued_chunks: 2, blocked_writers: 0, subscribers: 1,
+        batches: 120, chunks: 410}
+
+  `:chunks` divided by `:batches` is the average number of chunks coalesced
+  into one native call.
+  """
+  @spec status(t()) :: %{atom() => non_neg_integer()}
+  def status(stream) do
+    GenServer.call(stream, :status)
+  end
+
+  @doc """
+  Stop the stream. Audio still queued is discarded.
+  """
+  @spec stop(t()) :: :ok
+  def stop(stream) do
+    GenServer.stop(stream)
+  end
+
+  @impl true
+  def init(opts) do
+    with {:ok, recognizer} <- recognizer(opts),
+         {:ok, restored} <- restore(recognizer, opts) do
+      Enum.each(Keyword.get(opts, :subscribers, []), &Process.monitor/1)
+
+      state = %{
+        recognizer: recognizer,
+        feed_opts: [
+          partial: Keyword.get(opts, :partial, :changed),
+          decode: Keyword.get(opts, :decode, :jason)
+        ],
+        decode: Keyword.get(opts, :decode, :jason),
+        max_queue_bytes: Keyword.get(opts, :max_queue_bytes, @default_max_queue_bytes),
+        max_batch_bytes: Keyword.get(opts, :max_batch_bytes, @default_max_batch_bytes),
+        subscribers: MapSet.new(Keyword.get(opts, :subscribers, [])),
+        # Chunks as {producer, binary}, where producer is a pid to ack or nil
+        queue: :queue.new(),
+        queued_bytes: 0,
+        # write/3 callers whose reply waits for the queue to drain
+        blocked: :queue.new(),
+        decode_scheduled: false,
+        batches: 0,
+        chunks: 0
+      }
+
+      if restored, do: notify(state, restored)
+      {:ok, state}
+    else
+      {:error, reason} -> {:stop, reason}
+    end
+  end
+
+  @impl true
+  def handle_call({:write, audio}, from, state) do
+    state = enqueue(state, nil, audio)
+
+    if state.queued_bytes > state.max_queue_bytes do
+      {:noreply, %{state | blocked: :queue.in(from, state.blocked)}}
+    else
+      {:reply, :ok, state}
+    end
+  end
+
+  def handle_call(:flush, _from, state) do
+    state = decode_all(state)
+
+    reply = VoskEx.Recognizer.final_result(state.recognizer, decode: state.decode)
+
+    case reply do
+      {:ok, result} -> broadcast(state, {:final, result})
+      {:error, reason} -> broadcast(state, {:error, reason})
+    end
+
+    {:reply, reply, state}
+  end
+
+  def handle_call(:checkpoint, _from, state) do
+    state = decode_all(state)
+    {:reply, VoskEx.Recognizer.checkpoint(state.recognizer), state}
+  end
+
+  def handle_call({:subscribe, pid}, _from, state) do
+    unless MapSet.member?(state.subscribers, pid), do: Process.monitor(pid)
+    {:reply, :ok, %{state | subscribers: MapSet.put(state.subscribers, pid)}}
+  end
+
+  def handle_call({:unsubscribe, pid}, _from, state) do
+    {:reply, :ok, %{state | subscribers: MapSet.delete(state.subscribers, pid)}}
+  end
+
+  def handle_call(:status, _from, state) do
+    status = %{
+      queued_bytes: state.queued_bytes,
+      queued_chunks: :queue.len(state.queue),
+      blocked_writers: :queue.len(state.blocked),
+      subscribers: MapSet.size(state.subscribers),
+      batches: state.batches,
+      chunks: state.chunks
+    }
+
+    {:reply, status, state}
+  end
+
+  @impl true
+  def handle_cast({:push, pid, audio}, state) do
+    {:noreply, enqueue(state, pid, audio)}
+  end
+
+  @impl true
+  def handle_info(:decode, state) do
+    state = %{state | decode_scheduled: false}
+
+    # A flush or checkpoint may have decoded the queue since this was sent
+    if :queue.is_empty(state.queue) do
+      {:noreply, state}
+    else
+      case decode_batch(state) do
+        {:ok, state} -> {:noreply, schedule_decode(state)}
+        {:busy, state} -> {:noreply, schedule_decode(state, @busy_retry_ms)}
+      end
+    end
+  end
+
+  def handle_info({:DOWN, _ref, :process, pid, _reason}, state) do
+    {:noreply, %{state | subscribers: MapSet.delete(state.subscribers, pid)}}
+  end
+
+  defp recognizer(opts) do
+    case Keyword.fetch(opts, :recognizer) do
+      {:ok, %VoskEx.Recognizer{} = recognizer} ->
+        {:ok, recognizer}
+
+      :error ->
+        model = Keyword.fetch!(opts, :model)
+        sample_rate = Keyword.fetch!(opts, :sample_rate)
+        recognizer_opts = Keyword.get(opts, :recognizer_opts, [])
+
+        with {:ok, recognizer} <- VoskEx.Recognizer.new(model, sample_rate, recognizer_opts) do
+          configure(recognizer, opts)
+          {:ok, recognizer}
+        end
+    end
+  end
+
+  # Replay a checkpoint; an utterance it ends is passed on like a decoded one
+  defp restore(recognizer, opts) do
+    case Keyword.fetch(opts, :restore) do
+      {:ok, checkpoint} ->
+        case VoskEx.Recognizer.restore(recognizer, checkpoint) do
+          :continue ->
+            {:ok, nil}
+
+          :utterance_ended ->
+            decode = Keyword.get(opts, :decode, :jason)
+
+            with {:ok, result} <- VoskEx.Recognizer.result(recognizer, decode: decode) do
+              {:ok, {:utterance, result}}
+            end
+
+          :error ->
+            {:error, :restore_failed}
+
+          {:error, reason} ->
+            {:error, reason}
+        end
+
+      :error ->
+        {:ok, nil}
+    end
+  end
+
+  defp configure(recognizer, opts) do
+    Enum.each(opts, fn
+      {:words, enabled} -> VoskEx.Recognizer.set_words(recognizer, enabled)
+      {:partial_words, enabled} -> VoskEx.Recognizer.set_partial_words(recognizer, enabled)
+      {:max_alternatives, max} -> VoskEx.Recognizer.set_max_alternatives(recognizer, max)
+      _ -> :ok
+    end)
+  end
+
+  defp enqueue(state, producer, audio) do
+    audio = IO.iodata_to_binary(audio)
+
+    state = %{
+      state
+      | queue: :queue.in({producer, audio}, state.queue),
+        queued_bytes: state.queued_bytes + byte_size(audio)
+    }
+
+    schedule_decode(state)
+  end
+
+  # Decoding runs from a message rather than inline, so chunks that arrived
+  # during the previous native call are queued first and coalesced
+  defp schedule_decode(state, delay \\ 0)
+
+  defp schedule_decode(%{decode_scheduled: true} = state, _delay), do: state
+
+  defp schedule_decode(state, delay) do
+    cond do
+      :queue.is_empty(state.queue) ->
+        state
+
+      delay == 0 ->
+        send(self(), :decode)
+        %{state | decode_scheduled: true}
+
+      true ->
+        Process.send_after(self(), :decode, delay)
+        %{state | decode_scheduled: true}
+    end
+  end
+
+  defp decode_all(state) do
+    if :queue.is_empty(state.queue) do
+      state
+    else
+      case decode_batch(state) do
+        {:ok, state} ->
+          decode_all(state)
+
+        {:busy, state} ->
+          Process.sleep(@busy_retry_ms)
+          decode_all(state)
+      end
+    end
+  end
+
+  # Feed up to max_batch_bytes of queued chunks in one call (always at least
+  # one chunk), then ack producers and unblock writers
+  defp decode_batch(state) do
+    {batch, queue} = take_batch(state.queue, state.max_batch_bytes, [], 0)
+    audio = Enum.map(batch, fn {_producer, chunk} -> chunk end)
+
+    case VoskEx.Recognizer.feed(state.recognizer, audio, state.feed_opts) do
+      {:error, :busy} ->
+        {:busy, state}
+
+      reply ->
+        notify(state, reply)
+        bytes = IO.iodata_length(audio)
+        ack(batch)
+
+        state = %{
+          state
+          | queue: queue,
+            queued_bytes: state.queued_bytes - bytes,
+            batches: state.batches + 1,
+            chunks: state.chunks + length(batch)
+        }
+
+        {:ok, unblock(state)}
+    end
+  end
+
+  defp take_batch(queue, max_bytes, acc, bytes) do
+    case :queue.peek(queue) do
+      {:value, {_producer, chunk} = entry}
+      when acc == [] or bytes + byte_size(chunk) <= max_bytes ->
+        take_batch(:queue.drop(queue), max_bytes, [entry | acc], bytes + byte_size(chunk))
+
+      _ ->
+        {Enum.reverse(acc), queue}
+    end
+  end
+
+  defp notify(state, {:partial, _} = event), do: broadcast(state, event)
+  defp notify(state, {:utterance, _} = event), do: broadcast(state, event)
+  defp notify(_state, reply) when reply in [:unchanged, :continue], do: :ok
+  defp notify(state, :error), do: broadcast(state, {:error, :decode_failed})
+  defp notify(state, {:error, reason}), do: broadcast(state, {:error, reason})
+
+  defp broadcast(state, event) do
+    Enum.each(state.subscribers, &send(&1, {:vosk_stream, self(), event}))
+  end
+
+  defp ack(batch) do
+    batch
+    |> Enum.reject(fn {producer, _chunk} -> producer == nil end)
+    |> Enum.group_by(fn {producer, _} -> producer end, fn {_, chunk} -> byte_size(chunk) end)
+    |> Enum.each(fn {producer, sizes} ->
+      send(producer, {:vosk_stream, self(), {:ack, Enum.sum(sizes)}})
+    end)
+  end
+
+  defp unblock(state) do
+    case :queue.out(state.blocked) do
+      {{:value, from}, blocked} when state.queued_bytes <= state.max_queue_bytes ->
+        GenServer.reply(from, :ok)
+        unblock(%{state | blocked: blocked})
+
+      _ ->
+        state
+    end
+  end
+end
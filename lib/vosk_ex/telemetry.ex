@@ -0,0 +1,99 @@
+defmodule VoskEx.Telemetry do
+  @moduledoc """
+  Telemetry events emitted by VoskEx.
+
+  Every event is a `:stop` event emitted once the call returns. Durations are
+  in `:native` time units; convert them with `System.convert_time_unit/3`.
+
+  Recognizer events carry two timings. `:duration` is the wall time of the
+  call as seen by the caller, including dirty scheduler queueing. `:native_time`
+  is measured with a monotonic clock inside the NIF around the libvosk calls
+  (and the input stage), so it excludes BEAM scheduling noise. A call that
+  returned `{:error, :busy}` reports a `:native_time` of `0`.
+
+  ## Decoding
+
+  - `[:vosk_ex, :accept_waveform, :stop]` - `VoskEx.Recognizer.accept_waveform/3`
+  - `[:vosk_ex, :feed, :stop]` - `VoskEx.Recognizer.feed/3`
+  - `[:vosk_ex, :audio_buffer, :drain, :stop]` - `VoskEx.AudioBuffer.drain/2`
+  - `[:vosk_ex, :restore, :stop]` - `VoskEx.Recognizer.restore/2`, which
+    decodes the checkpoint's audio
+
+  `VoskEx.Recognizer.accept_waveform_async/2` emits no event, as the decode
+  finishes on a native thread. Its timing goes through the same counters, so
+  `VoskEx.Recognizer.stats/1` includes it and `VoskEx.last_call_stats/1`
+  covers the chunk behind the latest `{:vosk, ref, result}` message.
+
+  Measurements: `:duration`, `:native_time`, `:audio_duration` (the fed
+  audio, in native time units) and `:rtf`, the real-time factor
+  `native_time / audio_duration` (`nil` when no audio was fed). Metadata:
+  `:recognizer` and `:result`, the status returned to the caller without
+  any payload (`:utterance_ended`, `:continue`, `:partial`, `:error`, ...).
+
+  ## Results
+
+  - `[:vosk_ex, :result, :stop]` - `result/2`, `partial_result/2`,
+    `partial_result_if_changed/2` and `final_result/2` of `VoskEx.Recognizer`
+
+  Measurements: `:duration`, `:native_time`. Metadata: `:recognizer`, `:kind`
+  (`:result`, `:partial`, `:partial_if_changed` or `:final`) and `:decode`.
+
+  ## Models
+
+  - `[:vosk_ex, :model, :load, :stop]` - `VoskEx.Model.load/2`
+
+  Measurements: `:duration`. Metadata: `:path` and `:result` (`:ok` or the
+  error reason). A load of an already loaded path is reported too and is
+  nearly instant, see `VoskEx.Model.loaded/0`.
+
+  For pool events see `VoskEx.RecognizerPool`.
+  """
+
+  @doc false
+  def span_decode(event, %VoskEx.Recognizer{} = recognizer, fun) do
+    started = System.monotonic_time()
+    result = fun.()
+    duration = System.monotonic_time() - started
+    {native_time, audio_duration} = call_times(recognizer, result)
+
+    measurements = %{
+      duration: duration,
+      native_time: native_time,
+      audio_duration: audio_duration,
+      rtf: if(audio_duration > 0, do: native_time / audio_duration)
+    }
+
+    :telemetry.execute(event, measurements, %{recognizer: recognizer, result: tag(result)})
+    result
+  end
+
+  @doc false
+  def span_result(kind, decode, %VoskEx.Recognizer{} = recognizer, fun) do
+    started = System.monotonic_time()
+    result = fun.()
+    duration = System.monotonic_time() - started
+    {native_time, _audio_duration} = call_times(recognizer, result)
+
+    :telemetry.execute(
+      [:vosk_ex, :result, :stop],
+      %{duration: duration, native_time: native_time},
+      %{recognizer: recognizer, kind: kind, decode: decode}
+    )
+
+    result
+  end
+
+  # Calls that failed before claiming the recognizer did no native work
+  defp call_times(_recognizer, {:error, reason}) when reason in [:busy, :sample_rate_mismatch],
+    do: {0, 0}
+
+  defp call_times(%VoskEx.Recognizer{ref: ref}, _result) do
+    {native_ns, audio_ns} = VoskEx.last_call_stats(ref)
+
+    {System.convert_time_unit(native_ns, :nanosecond, :native),
+     System.convert_time_unit(audio_ns, :nanosecond, :native)}
+  end
+
+  defp tag({tag, _}) when is_atom(tag), do: tag
+  defp tag(result), do: result
+end
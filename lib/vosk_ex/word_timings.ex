@@ -0,0 +1,91 @@
+defmodule VoskEx.WordTimings do
+  @moduledoc """
+  Word timings as packed columns, returned by the `decode: :packed` option of
+  `VoskEx.Recognizer.result/2` and friends.
+
+  With word timings enabled, a long result holds tens of thousands of words.
+  Instead of one map per word, the NIF builds the columns directly:
+
+  - `:words` - every word's UTF-8 bytes, concatenated
+  - `:offsets` - native-endian unsigned 32-bit byte offsets into `:words`, one
+    per word plus the total length, so word `i` spans `offsets[i]` up to
+    `offsets[i + 1]`
+  - `:start`, `:end` - native-endian 32-bit floats, in seconds
+  - `:conf` - native-endian 32-bit floats, or `nil` when libvosk reports no
+    per-word confidence (word lists inside `"alternatives"`)
+
+  The binaries can be stored in ETS or handed to `Nx.from_binary/2` as they
+  are. `to_list/1` converts back to the map-per-word shape.
+  """
+
+  defstruct words: "", offsets: <<0::32-native>>, start: "", end: "", conf: nil
+
+  @type t :: %__MODULE__{
+          words: binary(),
+          offsets: binary(),
+          start: binary(),
+          end: binary(),
+          conf: binary() | nil
+        }
+
+  @doc """
+  Number of words.
+
+  ## Examples
+
+      iex> VoskEx.WordTimings.count(timings)
+      12
+  """
+  @spec count(t()) :: non_neg_integer()
+  def count(%__MODULE__{start: start}), do: div(byte_size(start), 4)
+
+  @doc """
+  List of the words.
+
+  ## Examples
+
+      iex> VoskEx.WordTimings.words(timings)
+      ["hello", "world"]
+  """
+  @spec words(t()) :: [String.t()]
+  def words(%__MODULE__{words: words, offsets: offsets}) do
+    offsets = for <<offset::32-native <- offsets>>, do: offset
+
+    offsets
+    |> Enum.zip(tl(offsets))
+    |> Enum.map(fn {from, to} -> binary_part(words, from, to - from) end)
+  end
+
+  @doc """
+  Convert to the map-per-word shape of unpacked results.
+
+  Times and confidences are 32-bit floats widened to 64 bits, so they may
+  differ from the JSON values in the last digits.
+
+  ## Examples
+
+      iex> VoskEx.WordTimings.to_list(timings)
+      [%{"word" => "hello", "start" => 0.84, "end" => 1.11, "conf" => 1.0}]
+  """
+  @spec to_list(t()) :: [%{String.t() => String.t() | float()}]
+  def to_list(%__MODULE__{} = timings) do
+    columns = [
+      words(timings),
+      floats(timings.start),
+      floats(timings.end),
+      if(timings.conf, do: floats(timings.conf), else: List.duplicate(nil, count(timings)))
+    ]
+
+    columns
+    |> Enum.zip()
+    |> Enum.map(fn
+      {word, start, stop, nil} ->
+        %{"word" => word, "start" => start, "end" => stop}
+
+      {word, start, stop, conf} ->
+        %{"word" => word, "start" => start, "end" => stop, "conf" => conf}
+    end)
+  end
+
+  defp floats(binary), do: for(<<x::float-32-native <- binary>>, do: x)
+end
@@ -38,6 +38,7 @@ defmodule VoskEx.MixProject do
     [
       {:elixir_make, "~> 0.8", runtime: false},
       {:jason, "~> 1.4"},
+      {:telemetry, "~> 1.0"},
       {:ex_doc, "~> 0.34", only: :dev, runtime: false}
     ]
   end
@@ -61,8 +62,19 @@ defmodule VoskEx.MixProject do
       main: "VoskEx",
       extras: ["README.md"],
       groups_for_modules: [
-        "Core API": [VoskEx, VoskEx.Model, VoskEx.Recognizer],
-        "Mix Tasks": [Mix.Tasks.Vosk.DownloadModel]
+        "Core API": [
+          VoskEx,
+          VoskEx.Model,
+          VoskEx.SpkModel,
+          VoskEx.Recognizer,
+          VoskEx.WordTimings,
+          VoskEx.AudioBuffer,
+          VoskEx.Stream,
+          VoskEx.Telemetry
+        ],
+        Pooling: [VoskEx.RecognizerPool, VoskEx.Cluster],
+        "Batch (GPU)": [VoskEx.BatchModel, VoskEx.BatchRecognizer],
+        "Mix Tasks": [Mix.Tasks.Vosk.DownloadModel, Mix.Tasks.Vosk.PrepareModel]
       ],
       assets: %{"assets" => "assets"}
     ]
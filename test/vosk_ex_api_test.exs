@@ -31,6 +31,80 @@ defmodule VoskExApiTest do
     assert Code.ensure_loaded?(VoskEx.Recognizer)
   end
 
+  test "node stats report counters and live recognizers" do
+    stats = VoskEx.stats()
+
+    for key <- [:samples_fed, :decode_ns, :utterances, :result_bytes, :models] do
+      assert is_integer(stats[key]) and stats[key] >= 0
+    end
+
+    assert stats.recognizers <= stats.recognizers_created
+    assert is_map(stats.model_memory)
+  end
+
+  test "build info names the CPU variant in use" do
+    info = VoskEx.build_info()
+
+    assert :default in info.cpu_variants
+    assert info.cpu_variant in info.cpu_variants
+    assert is_boolean(info.lto)
+    assert info.libvosk in [:bundled, :local]
+  end
+
+  test "audio_levels reports one dBFS level per 10 ms frame" do
+    silence = :binary.copy(<<0::16>>, 160)
+    loud = :binary.copy(<<32767::little-signed-16, -32768::little-signed-16>>, 80)
+
+    assert <<quiet::float-native-32, full::float-native-32>> =
+             VoskEx.audio_levels(silence <> loud <> <<1, 2>>, 16000)
+
+    assert quiet == -120.0
+    assert_in_delta full, 0.0, 0.01
+  end
+
+  test "transcribe_file fails cleanly for missing files" do
+    assert {:error, :enoent} = VoskEx.transcribe_file(%VoskEx.Model{ref: make_ref()}, "nope.wav")
+  end
+
+  test "cluster process reports this node and only picks nodes with the model" do
+    for spec <- VoskEx.Cluster.child_specs(interval: 50), do: start_supervised!(spec)
+
+    report =
+      Enum.find_value(1..50, fn _ ->
+        Process.sleep(20)
+        Enum.find(VoskEx.Cluster.nodes(), &(&1.node == node()))
+      end)
+
+    assert %{dirty_cpu_schedulers: schedulers, busy: busy} = report
+    assert schedulers > 0 and busy >= 0
+    assert {:error, :no_node} = VoskEx.Cluster.pick("no-such-model")
+  end
+
+  test "batch model loading fails cleanly for invalid paths" do
+    assert {:error, _} = VoskEx.BatchModel.load("invalid/path")
+  end
+
+  test "model loads emit a telemetry event" do
+    handler = "model-load-#{inspect(self())}"
+    test_pid = self()
+
+    :telemetry.attach(handler, [:vosk_ex, :model, :load, :stop], fn _, measurements, meta, _ ->
+      send(test_pid, {:model_load, measurements, meta})
+    end, nil)
+
+    assert {:error, :model_load_failed} = VoskEx.Model.load("invalid/path")
+
+    assert_receive {:model_load, %{duration: duration},
+                    %{path: "invalid/path", result: :model_load_failed}}
+
+    assert duration >= 0
+    :telemetry.detach(handler)
+  end
+
+  test "speaker model loading fails cleanly for invalid paths" do
+    assert {:error, :spk_model_load_failed} = VoskEx.SpkModel.load("invalid/path")
+  end
+
   @tag :integration
   test "can load a valid model" do
     if File.dir?(@model_path) do
@@ -43,6 +117,23 @@ defmodule VoskExApiTest do
     end
   end
 
+  @tag :integration
+  test "can load models asynchronously" do
+    if File.dir?(@model_path) do
+      refs = for _ <- 1..2, do: VoskEx.Model.load(@model_path, async: true)
+      assert Enum.all?(refs, &is_reference/1)
+
+      for ref <- refs do
+        assert {:ok, %VoskEx.Model{}} = VoskEx.Model.await(ref, 60_000)
+      end
+
+      ref = VoskEx.Model.load("invalid/path", async: true)
+      assert_receive {:vosk_model_loaded, ^ref, {:error, :model_load_failed}}, 60_000
+    else
+      IO.puts("\nSkipping async model test - model not found")
+    end
+  end
+
   @tag :integration
   test "can create a recognizer" do
     if File.dir?(@model_path) do
@@ -82,6 +173,648 @@ defmodule VoskExApiTest do
     end
   end
 
+  @tag :integration
+  test "raw results are returned as binaries" do
+    if File.dir?(@model_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, %VoskEx.Recognizer{ref: ref}} = VoskEx.Recognizer.new(model, 16000.0)
+
+      assert is_binary(VoskEx.get_partial_result(ref))
+      assert is_binary(VoskEx.get_result(ref))
+      assert is_binary(VoskEx.get_final_result(ref))
+    else
+      IO.puts("\nSkipping raw result test - model not found")
+    end
+  end
+
+  @tag :integration
+  test "native decoding matches Jason decoding" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      pcm_data = File.read!(audio_path)
+
+      [jason_rec, native_rec] =
+        for _ <- 1..2 do
+          {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0)
+          VoskEx.Recognizer.set_words(recognizer, true)
+          VoskEx.Recognizer.accept_waveform(recognizer, pcm_data)
+          recognizer
+        end
+
+      assert VoskEx.Recognizer.partial_result(native_rec, decode: :native) ==
+               VoskEx.Recognizer.partial_result(jason_rec)
+
+      {:ok, native} = VoskEx.Recognizer.final_result(native_rec, decode: :native)
+      {:ok, jason} = VoskEx.Recognizer.final_result(jason_rec)
+      assert native == jason
+      assert [%{"word" => _, "start" => _, "end" => _, "conf" => _} | _] = native["result"]
+    else
+      IO.puts("\nSkipping native decoding test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "packed word timings match the map-per-word result" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      pcm_data = File.read!(audio_path)
+
+      [jason, packed] =
+        for decode <- [:jason, :packed] do
+          {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0)
+          VoskEx.Recognizer.set_words(recognizer, true)
+          VoskEx.Recognizer.accept_waveform(recognizer, pcm_data)
+          {:ok, result} = VoskEx.Recognizer.final_result(recognizer, decode: decode)
+          result
+        end
+
+      assert packed["text"] == jason["text"]
+      assert %VoskEx.WordTimings{} = timings = packed["result"]
+      assert VoskEx.WordTimings.count(timings) == length(jason["result"])
+      assert VoskEx.WordTimings.words(timings) == Enum.map(jason["result"], & &1["word"])
+
+      for {word, expected} <- Enum.zip(VoskEx.WordTimings.to_list(timings), jason["result"]) do
+        assert_in_delta word["start"], expected["start"], 1.0e-5
+        assert_in_delta word["end"], expected["end"], 1.0e-5
+        assert_in_delta word["conf"], expected["conf"], 1.0e-5
+      end
+    else
+      IO.puts("\nSkipping packed word timings test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "accept_waveform_async replies in order" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0)
+      ref = recognizer.ref
+
+      chunks = for <<chunk::binary-size(8000) <- File.read!(audio_path)>>, do: chunk
+      Enum.each(chunks, &(:ok = VoskEx.Recognizer.accept_waveform_async(recognizer, &1)))
+
+      for _ <- chunks do
+        assert_receive {:vosk, ^ref, result} when result in [:continue, :utterance_ended], 10_000
+      end
+
+      # Each async decode is its own call: 8000 bytes of s16le at 16 kHz
+      assert {native_ns, 250_000_000} = VoskEx.last_call_stats(ref)
+      assert native_ns > 0
+
+      {:ok, result} = VoskEx.Recognizer.final_result(recognizer)
+      assert result["text"] =~ "hello one two three"
+    else
+      IO.puts("\nSkipping async test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "streams decode written and pushed audio and ack pushes" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+
+      {:ok, stream} =
+        VoskEx.Stream.start(
+          model: model,
+          sample_rate: 16000.0,
+          subscribers: [self()],
+          max_queue_bytes: 16_000
+        )
+
+      chunks = for <<chunk::binary-size(3200) <- File.read!(audio_path)>>, do: chunk
+      {written, pushed} = Enum.split(chunks, div(length(chunks), 2))
+
+      Enum.each(written, &(:ok = VoskEx.Stream.write(stream, &1)))
+      Enum.each(pushed, &VoskEx.Stream.push(stream, &1))
+
+      {:ok, final} = VoskEx.Stream.flush(stream)
+      assert_receive {:vosk_stream, ^stream, {:final, ^final}}
+
+      acked = collect_acks(stream, 0)
+      assert acked == pushed |> Enum.map(&byte_size/1) |> Enum.sum()
+
+      utterances =
+        for {:vosk_stream, ^stream, {:utterance, result}} <- flush_messages(), do: result["text"]
+
+      assert Enum.join(utterances ++ [final["text"]], " ") =~ "hello one two three"
+
+      status = VoskEx.Stream.status(stream)
+      assert status.chunks == length(chunks)
+      assert status.batches <= status.chunks
+      assert status.queued_bytes == 0
+
+      # The :decode left pending by a flush must not feed an empty batch
+      VoskEx.Stream.push(stream, hd(chunks))
+      {:ok, _} = VoskEx.Stream.flush(stream)
+      assert VoskEx.Stream.status(stream).batches == status.batches + 1
+
+      VoskEx.Stream.stop(stream)
+    else
+      IO.puts("\nSkipping stream test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "transcribe_file decodes segments in parallel with file-relative word times" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      duration = File.stat!(audio_path).size / 32000
+
+      {:ok, result} =
+        VoskEx.transcribe_file(model, audio_path, concurrency: 2, segment_seconds: 5)
+
+      assert result["text"] =~ "hello one two three"
+      assert result["text"] =~ "thank you for listening"
+
+      starts = Enum.map(result["result"], & &1["start"])
+      assert starts == Enum.sort(starts)
+      assert List.last(result["result"])["end"] <= duration
+      assert List.last(result["result"])["end"] > duration / 2
+    else
+      IO.puts("\nSkipping file transcription test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "checkpoints move the utterance in progress to another recognizer" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      audio = File.read!(audio_path)
+      duration = byte_size(audio) / 32000
+      chunks = for <<chunk::binary-size(3200) <- audio>>, do: chunk
+      {before, later} = Enum.split(chunks, div(length(chunks), 2))
+
+      {:ok, original} = VoskEx.Recognizer.new(model, 16000.0, checkpoint: true)
+      VoskEx.Recognizer.set_words(original, true)
+      first = decode_chunks(original, before)
+
+      {:ok, checkpoint} = VoskEx.Recognizer.checkpoint(original)
+      assert {:error, :invalid_checkpoint} = VoskEx.Recognizer.restore(original, "VXCK")
+
+      {:ok, other_rate} = VoskEx.Recognizer.new(model, 8000.0)
+      assert {:error, :sample_rate_mismatch} = VoskEx.Recognizer.restore(other_rate, checkpoint)
+
+      {:ok, moved} = VoskEx.Recognizer.new(model, 16000.0, checkpoint: true)
+      assert VoskEx.Recognizer.restore(moved, checkpoint) == :continue
+      assert {:error, :not_idle} = VoskEx.Recognizer.restore(moved, checkpoint)
+
+      results = first ++ decode_chunks(moved, later)
+      {:ok, final} = VoskEx.Recognizer.final_result(moved)
+      results = results ++ [final]
+
+      text = Enum.map_join(results, " ", & &1["text"])
+      assert text =~ "hello one two three"
+      assert text =~ "thank you for listening"
+
+      words = Enum.flat_map(results, &Map.get(&1, "result", []))
+      starts = Enum.map(words, & &1["start"])
+      assert starts == Enum.sort(starts)
+      assert List.last(words)["end"] <= duration
+      assert List.last(words)["end"] > duration / 2
+
+      # reset/1 drops the restored timeline: move the checkpoint 1000 s on
+      <<"VXCK", version, rate::binary-size(8), _start::little-64, rest::binary>> = checkpoint
+      far = <<"VXCK", version, rate::binary, 16_000_000::little-64, rest::binary>>
+      {:ok, shifted} = VoskEx.Recognizer.new(model, 16000.0, checkpoint: true)
+      assert VoskEx.Recognizer.restore(shifted, far) == :continue
+      :ok = VoskEx.Recognizer.reset(shifted)
+      assert VoskEx.Recognizer.accept_waveform(shifted, audio) in [:continue, :utterance_ended]
+      {:ok, final} = VoskEx.Recognizer.final_result(shifted)
+      assert List.last(final["result"])["end"] <= 2 * duration
+
+      {:ok, plain} = VoskEx.Recognizer.new(model, 16000.0)
+      assert {:error, :checkpoints_disabled} = VoskEx.Recognizer.checkpoint(plain)
+    else
+      IO.puts("\nSkipping checkpoint test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "endpointer ends utterances at the configured length" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      audio = File.read!(audio_path)
+      chunks = for <<chunk::binary-size(1600) <- audio>>, do: chunk
+
+      {:ok, rec} = VoskEx.Recognizer.new(model, 16000.0, endpointer: [max_utterance_ms: 2000])
+
+      ended =
+        for {chunk, i} <- Enum.with_index(chunks, 1),
+            VoskEx.Recognizer.accept_waveform(rec, chunk) == :utterance_ended do
+          {:ok, result} = VoskEx.Recognizer.result(rec)
+          {i, result}
+        end
+
+      # One utterance per 2 s at the latest, each with its own result
+      assert length(ended) >= div(length(chunks), 40)
+      assert {first, _} = hd(ended)
+      assert first <= 40
+      assert Enum.map_join(ended, " ", fn {_, r} -> r["text"] end) =~ "one two"
+
+      assert :ok = VoskEx.Recognizer.set_endpointer(rec, [])
+
+      assert_raise ArgumentError, fn ->
+        VoskEx.Recognizer.set_endpointer(rec, trailing_silence_ms: -5)
+      end
+    else
+      IO.puts("\nSkipping endpointer test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "loading a model path twice shares one native model" do
+    if File.dir?(@model_path) do
+      {:ok, first} = VoskEx.Model.load(@model_path)
+      {:ok, second} = VoskEx.Model.load(@model_path <> "/.")
+
+      name = Path.basename(@model_path)
+      entries = Enum.filter(VoskEx.Model.loaded(), &(Path.basename(&1.path) == name))
+      assert [%{handles: handles}] = entries
+      assert handles >= 2
+
+      assert VoskEx.Model.find_word(first, "one") == VoskEx.Model.find_word(second, "one")
+    else
+      IO.puts("\nSkipping shared model test - model not found")
+    end
+  end
+
+  @tag :integration
+  test "feed returns utterances and partials in one call" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0)
+
+      results =
+        for <<chunk::binary-size(3200) <- File.read!(audio_path)>> do
+          VoskEx.Recognizer.feed(recognizer, chunk)
+        end
+
+      assert Enum.all?(results, &match?({kind, %{}} when kind in [:utterance, :partial], &1))
+      assert {:partial, %{"partial" => _}} = List.first(results)
+
+      assert VoskEx.Recognizer.feed(recognizer, <<0::16>>, partial: false) in [
+               :continue,
+               {:utterance, %{"text" => ""}}
+             ]
+
+      # iodata and f32le are accepted like in accept_waveform
+      silence = [<<0::16>>, [<<0::16>>, <<0::16>>]]
+      f32 = <<0.0::float-little-32, 0.0::float-little-32>>
+
+      for reply <- [
+            VoskEx.Recognizer.feed(recognizer, silence),
+            VoskEx.Recognizer.feed(recognizer, f32, format: :f32le)
+          ] do
+        assert match?({kind, %{}} when kind in [:utterance, :partial], reply)
+      end
+    else
+      IO.puts("\nSkipping feed test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "partial results are only returned when they change" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0)
+      <<chunk::binary-size(32_000), _::binary>> = File.read!(audio_path)
+
+      VoskEx.Recognizer.accept_waveform(recognizer, chunk)
+      assert {:ok, partial} = VoskEx.Recognizer.partial_result_if_changed(recognizer)
+      assert {:ok, ^partial} = VoskEx.Recognizer.partial_result(recognizer)
+      assert :unchanged = VoskEx.Recognizer.partial_result_if_changed(recognizer)
+
+      :ok = VoskEx.Recognizer.reset(recognizer)
+      silence = :binary.copy(<<0::16>>, 1600)
+
+      assert {:partial, %{"partial" => ""}} =
+               VoskEx.Recognizer.feed(recognizer, silence, partial: :changed)
+
+      assert :unchanged = VoskEx.Recognizer.feed(recognizer, silence, partial: :changed)
+    else
+      IO.puts("\nSkipping partial change test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "decoding emits telemetry with native timing and real-time factor" do
+    if File.dir?(@model_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0)
+      handler = "decode-#{inspect(self())}"
+      test_pid = self()
+
+      :telemetry.attach_many(
+        handler,
+        [[:vosk_ex, :accept_waveform, :stop], [:vosk_ex, :result, :stop]],
+        fn event, measurements, meta, _ -> send(test_pid, {event, measurements, meta}) end,
+        nil
+      )
+
+      # Half a second of silence
+      VoskEx.Recognizer.accept_waveform(recognizer, :binary.copy(<<0::16>>, 8000))
+
+      assert_receive {[:vosk_ex, :accept_waveform, :stop], measurements, %{result: :continue}}
+      audio_ms = System.convert_time_unit(measurements.audio_duration, :native, :millisecond)
+      assert audio_ms in 499..500
+      assert measurements.native_time > 0
+      assert measurements.native_time <= measurements.duration
+      assert is_float(measurements.rtf)
+
+      {:ok, _} = VoskEx.Recognizer.final_result(recognizer)
+      assert_receive {[:vosk_ex, :result, :stop], %{native_time: _}, %{kind: :final}}
+
+      :telemetry.detach(handler)
+    else
+      IO.puts("\nSkipping telemetry test - model not found")
+    end
+  end
+
+  @tag :integration
+  test "recognizer stats count fed audio and results" do
+    if File.dir?(@model_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0)
+      before = VoskEx.stats()
+
+      assert %{samples_fed: 0, utterances: 0} = VoskEx.Recognizer.stats(recognizer)
+
+      VoskEx.Recognizer.accept_waveform(recognizer, :binary.copy(<<0::16>>, 16000))
+      {:ok, _} = VoskEx.Recognizer.final_result(recognizer)
+
+      stats = VoskEx.Recognizer.stats(recognizer)
+      assert stats.samples_fed == 16000
+      assert stats.audio_seconds == 1.0
+      assert stats.utterances == 1
+      assert stats.result_bytes > 0
+      assert stats.decode_ns > 0
+
+      node = VoskEx.stats()
+      assert node.samples_fed >= before.samples_fed + 16000
+      assert node.recognizers >= 1
+      assert node.models >= 1
+      assert Enum.any?(node.model_memory, fn {_path, bytes} -> bytes > 0 end)
+    else
+      IO.puts("\nSkipping stats test - model not found")
+    end
+  end
+
+  @tag :integration
+  test "accept_waveform takes iolists and splits long inputs on request" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      audio = File.read!(audio_path)
+
+      {:ok, whole} = VoskEx.Recognizer.new(model, 16000.0)
+      texts = feed_all(whole, audio, [])
+
+      {:ok, %{"text" => last}} = VoskEx.Recognizer.final_result(whole)
+      assert String.trim(Enum.join(texts ++ [last], " ")) != ""
+
+      {:ok, iolist} = VoskEx.Recognizer.new(model, 16000.0)
+      <<a::binary-size(1600), b::binary-size(1600), _::binary>> = audio
+      assert VoskEx.Recognizer.accept_waveform(iolist, [a, [b]]) in [:continue, :utterance_ended]
+    else
+      IO.puts("\nSkipping long input test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "accept_waveform with f32le samples matches s16le" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      s16 = File.read!(audio_path)
+      f32 = for <<s::signed-little-16 <- s16>>, into: <<>>, do: <<s / 32768::float-little-32>>
+
+      {:ok, rec_s16} = VoskEx.Recognizer.new(model, 16000.0)
+      {:ok, rec_f32} = VoskEx.Recognizer.new(model, 16000.0)
+
+      for <<chunk::binary-size(3200) <- s16>> do
+        VoskEx.Recognizer.accept_waveform(rec_s16, chunk)
+      end
+
+      for <<chunk::binary-size(6400) <- f32>> do
+        VoskEx.Recognizer.accept_waveform(rec_f32, chunk, format: :f32le)
+      end
+
+      assert VoskEx.Recognizer.final_result(rec_f32) == VoskEx.Recognizer.final_result(rec_s16)
+
+      assert_raise ArgumentError, fn ->
+        VoskEx.Recognizer.accept_waveform(rec_s16, <<>>, format: :u8)
+      end
+    else
+      IO.puts("\nSkipping f32le test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "input stage downmixes and resamples to the recognizer rate" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      mono = File.read!(audio_path)
+
+      # 16 kHz mono -> 32 kHz stereo by duplicating every sample
+      stereo =
+        for <<s::binary-size(2) <- mono>>, into: <<>> do
+          <<s::binary, s::binary, s::binary, s::binary>>
+        end
+
+      {:ok, rec} = VoskEx.Recognizer.new(model, 16000.0, input_rate: 32000, channels: 2)
+
+      for <<chunk::binary-size(12800) <- stereo>> do
+        VoskEx.Recognizer.accept_waveform(rec, chunk)
+      end
+
+      {:ok, %{"text" => text}} = VoskEx.Recognizer.final_result(rec)
+      assert String.length(text) > 0
+
+      assert {:error, :invalid_input_format} =
+               VoskEx.Recognizer.new(model, 16000.0, input_rate: 16000, channels: 0)
+    else
+      IO.puts("\nSkipping input stage test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "silence gate skips padding and keeps word times on the input timeline" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      # Ten seconds of silence ahead of the speech
+      audio = :binary.copy(<<0::16>>, 160_000) <> File.read!(audio_path)
+
+      {:ok, plain} = VoskEx.Recognizer.new(model, 16000.0)
+      {:ok, gated} = VoskEx.Recognizer.new(model, 16000.0, vad: true)
+
+      for rec <- [plain, gated] do
+        VoskEx.Recognizer.set_words(rec, true)
+
+        for <<chunk::binary-size(3200) <- audio>> do
+          VoskEx.Recognizer.accept_waveform(rec, chunk)
+        end
+      end
+
+      {:ok, expected} = VoskEx.Recognizer.final_result(plain)
+      {:ok, actual} = VoskEx.Recognizer.final_result(gated)
+
+      assert actual["text"] == expected["text"]
+
+      for {want, got} <- Enum.zip(expected["result"] || [], actual["result"] || []) do
+        assert_in_delta got["start"], want["start"], 0.25
+      end
+
+      assert {:ok, %{skipped_frames: skipped}} = VoskEx.Recognizer.vad_stats(gated)
+      assert skipped > 500
+      assert {:error, :vad_disabled} = VoskEx.Recognizer.vad_stats(plain)
+    else
+      IO.puts("\nSkipping silence gate test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "audio buffer decodes appended packets in blocks" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      raw = File.read!(audio_path)
+      audio = binary_part(raw, 0, div(byte_size(raw), 640) * 640)
+
+      # Reference: the same 3200-byte blocks the buffer decodes, then the tail
+      {:ok, direct} = VoskEx.Recognizer.new(model, 16000.0)
+      blocks = div(byte_size(audio), 3200) * 3200
+      <<whole::binary-size(blocks), tail::binary>> = audio
+
+      for <<chunk::binary-size(3200) <- whole>> do
+        VoskEx.Recognizer.accept_waveform(direct, chunk)
+      end
+
+      VoskEx.Recognizer.accept_waveform(direct, tail)
+
+      {:ok, rec} = VoskEx.Recognizer.new(model, 16000.0)
+      {:ok, buffer} = VoskEx.AudioBuffer.new(rec, capacity: byte_size(audio), notify: self())
+
+      # 20 ms packets, split unevenly into iolists
+      for <<a::binary-size(100), b::binary-size(540) <- audio>> do
+        :ok = VoskEx.AudioBuffer.append(buffer, [a, b])
+      end
+
+      assert_received {:vosk_audio_buffer, _, :ready}
+      assert {:error, :overflow} = VoskEx.AudioBuffer.append(buffer, audio)
+      assert VoskEx.AudioBuffer.overflows(buffer) == 1
+
+      drain_all(buffer)
+      assert VoskEx.AudioBuffer.pending(buffer) == 0
+
+      assert VoskEx.Recognizer.final_result(buffer.recognizer) ==
+               VoskEx.Recognizer.final_result(direct)
+    else
+      IO.puts("\nSkipping audio buffer test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "audio buffer sends :ready again after a drain stops early" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      audio = File.read!(audio_path)
+
+      {:ok, rec} = VoskEx.Recognizer.new(model, 16000.0)
+      {:ok, buffer} = VoskEx.AudioBuffer.new(rec, capacity: byte_size(audio), notify: self())
+      :ok = VoskEx.AudioBuffer.append(buffer, audio)
+
+      # One drain per message, as in the moduledoc; utterance ends and the
+      # 64 KiB budget both stop a drain with audio left over
+      {statuses, texts} = drain_on_ready(buffer, [], [])
+
+      assert :utterance_ended in statuses
+      assert VoskEx.AudioBuffer.pending(buffer) < 3200
+
+      {:ok, %{"text" => last}} = VoskEx.Recognizer.final_result(rec)
+      assert Enum.join(texts ++ [last], " ") =~ "thank you for listening"
+    else
+      IO.puts("\nSkipping audio buffer ready test - model or audio not found")
+    end
+  end
+
+  defp drain_on_ready(buffer, statuses, texts) do
+    receive do
+      {:vosk_audio_buffer, _, :ready} ->
+        case VoskEx.AudioBuffer.drain(buffer) do
+          :utterance_ended ->
+            {:ok, %{"text" => text}} = VoskEx.Recognizer.result(buffer.recognizer)
+            drain_on_ready(buffer, [:utterance_ended | statuses], texts ++ [text])
+
+          status ->
+            drain_on_ready(buffer, [status | statuses], texts)
+        end
+    after
+      1000 -> {Enum.reverse(statuses), texts}
+    end
+  end
+
+  defp drain_all(buffer) do
+    VoskEx.AudioBuffer.drain(buffer, flush: true)
+    if VoskEx.AudioBuffer.pending(buffer) > 0, do: drain_all(buffer)
+  end
+
+  defp feed_all(recognizer, audio, texts) do
+    case VoskEx.Recognizer.accept_waveform(recognizer, audio, split: true) do
+      {:utterance_ended, rest} ->
+        {:ok, %{"text" => text}} = VoskEx.Recognizer.result(recognizer)
+        feed_all(recognizer, rest, texts ++ [text])
+
+      result when result in [:continue, :utterance_ended] ->
+        texts
+    end
+  end
+
+  @tag :integration
+  test "concurrent use of a recognizer returns :busy" do
+    if File.dir?(@model_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0)
+
+      # Thirty seconds of silence keeps the recognizer busy for a while
+      audio = :binary.copy(<<0::16>>, 16000 * 30)
+      task = Task.async(fn -> VoskEx.Recognizer.accept_waveform(recognizer, audio) end)
+      Process.sleep(5)
+
+      assert {:error, :busy} = VoskEx.Recognizer.partial_result(recognizer)
+      assert Task.await(task, 60_000) in [:continue, :utterance_ended]
+      assert {:ok, _} = VoskEx.Recognizer.partial_result(recognizer)
+    else
+      IO.puts("\nSkipping busy test - model not found")
+    end
+  end
+
   @tag :integration
   test "can find words in model vocabulary" do
     if File.dir?(@model_path) do
@@ -99,6 +832,84 @@ defmodule VoskExApiTest do
     end
   end
 
+  @tag :integration
+  test "find_words looks up a list in one call and matches the exported vocabulary" do
+    if File.dir?(@model_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      words = ["the", "xyzqwerty123", "one", String.duplicate("a", 300), "two"]
+
+      symbols = VoskEx.Model.find_words(model, words)
+      assert symbols == Enum.map(words, &VoskEx.Model.find_word(model, &1))
+      assert [the, -1, one, -1, two] = symbols
+      assert VoskEx.Model.find_words(model, []) == []
+
+      {:ok, vocabulary} = VoskEx.Model.vocabulary(model)
+      entries = :binary.split(vocabulary, "\n", [:global])
+      assert Enum.at(entries, the) == "the"
+      assert Enum.at(entries, one) == "one"
+      assert Enum.at(entries, two) == "two"
+
+      # Kept with the loaded model, so a second handle gets the same data
+      {:ok, other} = VoskEx.Model.load(@model_path)
+      assert VoskEx.Model.vocabulary(other) == {:ok, vocabulary}
+    else
+      IO.puts("\nSkipping find_words test - model not found")
+    end
+  end
+
+  @tag :integration
+  test "grammar restricts recognition to its phrases" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      grammar = ["one two three", "thank you", "[unk]"]
+      {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0, grammar: grammar)
+
+      VoskEx.Recognizer.accept_waveform(recognizer, File.read!(audio_path))
+      {:ok, result} = VoskEx.Recognizer.final_result(recognizer)
+
+      allowed = grammar |> Enum.flat_map(&String.split/1) |> MapSet.new()
+      assert result["text"] =~ "one two three"
+      assert result["text"] |> String.split() |> Enum.all?(&MapSet.member?(allowed, &1))
+
+      assert :ok = VoskEx.Recognizer.set_grammar(recognizer, [])
+      VoskEx.Recognizer.accept_waveform(recognizer, File.read!(audio_path))
+      {:ok, result} = VoskEx.Recognizer.final_result(recognizer)
+      assert result["text"] =~ "welcome to this demonstration"
+
+      assert_raise ArgumentError, fn -> VoskEx.Recognizer.set_grammar(recognizer, [:one]) end
+    else
+      IO.puts("\nSkipping grammar test - model or audio not found")
+    end
+  end
+
+  @tag :integration
+  test "speaker vectors come back packed with either decoder" do
+    audio_path = "test/test_audio.raw"
+    spk_path = System.get_env("SPK_MODEL_PATH") || "models/vosk-model-spk-0.4"
+
+    if File.dir?(@model_path) and File.dir?(spk_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, spk} = VoskEx.SpkModel.load(spk_path)
+
+      results =
+        for decode <- [:jason, :native] do
+          {:ok, recognizer} = VoskEx.Recognizer.new(model, 16000.0, speaker_model: spk)
+          VoskEx.Recognizer.accept_waveform(recognizer, File.read!(audio_path))
+          {:ok, result} = VoskEx.Recognizer.final_result(recognizer, decode: decode)
+          result
+        end
+
+      [%{"spk" => jason}, %{"spk" => native}] = results
+      assert is_binary(native) and byte_size(native) > 0 and rem(byte_size(native), 4) == 0
+      assert byte_size(jason) == byte_size(native)
+      assert VoskEx.SpkModel.cosine_similarity(jason, native) > 0.999
+    else
+      IO.puts("\nSkipping speaker test - model, speaker model or audio not found")
+    end
+  end
+
   @tag :integration
   test "transcribes test_audio.raw file" do
     audio_path = "test/test_audio.raw"
@@ -130,4 +941,60 @@ defmodule VoskExApiTest do
       end
     end
   end
+
+  @tag :integration
+  test "a whole file fed in one call is decoded in full" do
+    audio_path = "test/test_audio.raw"
+
+    if File.dir?(@model_path) and File.exists?(audio_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      pcm_data = File.read!(audio_path)
+      expected = "hello one two three welcome to this demonstration thank you for listening"
+
+      {:ok, whole} = VoskEx.Recognizer.new(model, 16000.0)
+      assert VoskEx.Recognizer.accept_waveform(whole, pcm_data) in [:continue, :utterance_ended]
+      assert {:ok, %{"text" => ^expected}} = VoskEx.Recognizer.final_result(whole)
+
+      # With split: true every utterance end hands the rest back
+      {:ok, split} = VoskEx.Recognizer.new(model, 16000.0)
+      texts = feed_all(split, pcm_data, [])
+      {:ok, final} = VoskEx.Recognizer.final_result(split)
+
+      text = Enum.join(texts ++ [final["text"]], " ")
+      assert text =~ "hello one two three"
+      assert text =~ "thank you for listening"
+    else
+      IO.puts("\nSkipping whole file test - model or audio not found")
+    end
+  end
+
+  defp collect_acks(stream, total) do
+    receive do
+      {:vosk_stream, ^stream, {:ack, bytes}} -> collect_acks(stream, total + bytes)
+    after
+      0 -> total
+    end
+  end
+
+  defp flush_messages do
+    receive do
+      message -> [message | flush_messages()]
+    after
+      0 -> []
+    end
+  end
+
+  # Utterance results of feeding `chunks` one by one
+  defp decode_chunks(recognizer, chunks) do
+    Enum.flat_map(chunks, fn chunk ->
+      case VoskEx.Recognizer.accept_waveform(recognizer, chunk) do
+        :utterance_ended ->
+          {:ok, result} = VoskEx.Recognizer.result(recognizer)
+          [result]
+
+        :continue ->
+          []
+      end
+    end)
+  end
 end
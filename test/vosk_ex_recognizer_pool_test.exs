@@ -0,0 +1,87 @@
+defmodule VoskExRecognizerPoolTest do
+  use ExUnit.Case
+
+  @model_path System.get_env("MODEL_PATH") || "models/vosk-model-small-en-us-0.15"
+
+  test "pool supervisor is started with the application" do
+    assert is_pid(Process.whereis(VoskEx.RecognizerPool))
+  end
+
+  @tag :integration
+  test "same key returns the same pool" do
+    if File.dir?(@model_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, pool} = VoskEx.RecognizerPool.get(model, 16000, words: true)
+
+      assert {:ok, ^pool} = VoskEx.RecognizerPool.get(model, 16000.0, words: true, max: 99)
+      assert {:ok, other} = VoskEx.RecognizerPool.get(model, 8000.0, words: true)
+      assert other != pool
+    else
+      IO.puts("\nSkipping pool test - model not found")
+    end
+  end
+
+  @tag :integration
+  test "checkout, checkin and saturation" do
+    if File.dir?(@model_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, pool} = VoskEx.RecognizerPool.get(model, 16000.0, min: 1, max: 2)
+
+      assert %{size: 1, idle: 1} = VoskEx.RecognizerPool.status(pool)
+
+      {:ok, rec1} = VoskEx.RecognizerPool.checkout(pool)
+      {:ok, rec2} = VoskEx.RecognizerPool.checkout(pool)
+      assert %{size: 2, in_use: 2, idle: 0} = VoskEx.RecognizerPool.status(pool)
+
+      assert {:error, :timeout} = VoskEx.RecognizerPool.checkout(pool, 50)
+
+      :ok = VoskEx.RecognizerPool.checkin(pool, rec1)
+      {:ok, rec3} = VoskEx.RecognizerPool.checkout(pool)
+      assert rec3.ref == rec1.ref
+
+      :ok = VoskEx.RecognizerPool.checkin(pool, rec2)
+      :ok = VoskEx.RecognizerPool.checkin(pool, rec3)
+      assert %{size: 2, in_use: 0, idle: 2} = VoskEx.RecognizerPool.status(pool)
+    else
+      IO.puts("\nSkipping pool test - model not found")
+    end
+  end
+
+  @tag :integration
+  test "recognizers are reclaimed when the owner exits" do
+    if File.dir?(@model_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, pool} = VoskEx.RecognizerPool.get(model, 22050.0, min: 0, max: 1)
+
+      task = Task.async(fn -> VoskEx.RecognizerPool.checkout(pool) end)
+      assert {:ok, %VoskEx.Recognizer{}} = Task.await(task)
+
+      assert {:ok, %VoskEx.Recognizer{}} = VoskEx.RecognizerPool.checkout(pool, 1000)
+    else
+      IO.puts("\nSkipping pool test - model not found")
+    end
+  end
+
+  @tag :integration
+  test "an unused pool stops and get/3 starts a new one" do
+    if File.dir?(@model_path) do
+      {:ok, model} = VoskEx.Model.load(@model_path)
+      {:ok, pool} = VoskEx.RecognizerPool.get(model, 11025.0, min: 1, idle_timeout: 50)
+      monitor = Process.monitor(pool)
+
+      {:ok, rec} = VoskEx.RecognizerPool.checkout(pool)
+      refute_receive {:DOWN, ^monitor, :process, _, _}, 200
+      :ok = VoskEx.RecognizerPool.checkin(pool, rec)
+
+      assert_receive {:DOWN, ^monitor, :process, _, :normal}, 1000
+      assert {:error, :pool_stopped} = VoskEx.RecognizerPool.checkout(pool)
+      assert {:error, :pool_stopped} = VoskEx.RecognizerPool.status(pool)
+
+      {:ok, new_pool} = VoskEx.RecognizerPool.get(model, 11025.0, min: 1, idle_timeout: 50)
+      assert new_pool != pool
+      assert %{size: 1} = VoskEx.RecognizerPool.status(new_pool)
+    else
+      IO.puts("\nSkipping pool test - model not found")
+    end
+  end
+end